@@ -148,6 +148,10 @@ else
         # This will effectively work the same as "transient" if not supported by the chip
         SRC += $(PLATFORM_COMMON_DIR)/eeprom_teensy.c
       endif
+      ifneq ($(filter -DSTM32_EEPROM_ENABLE,$(OPT_DEFS)),)
+        # Fails the link if the firmware grows into the emulated EEPROM pages
+        LDFLAGS += $(PLATFORM_COMMON_DIR)/eeprom_stm32.ld
+      endif
     else ifeq ($(PLATFORM),ARM_ATSAM)
       SRC += $(PLATFORM_COMMON_DIR)/eeprom.c
     else ifeq ($(PLATFORM),TEST)
@@ -426,6 +430,21 @@ ifneq ($(strip $(CUSTOM_MATRIX)), yes)
     endif
 endif
 
+VALID_MATRIX_SCAN_MODES := polling interrupt
+
+MATRIX_SCAN_MODE ?= polling
+
+ifeq ($(filter $(MATRIX_SCAN_MODE),$(VALID_MATRIX_SCAN_MODES)),)
+    $(error MATRIX_SCAN_MODE="$(MATRIX_SCAN_MODE)" is not a valid matrix scan mode)
+endif
+
+ifeq ($(strip $(MATRIX_SCAN_MODE)), interrupt)
+    ifneq ($(strip $(CUSTOM_MATRIX)), no)
+        $(error MATRIX_SCAN_MODE="interrupt" requires the standard matrix (CUSTOM_MATRIX = no))
+    endif
+    OPT_DEFS += -DMATRIX_SCAN_INTERRUPT
+endif
+
 # Support for translating old names to new names:
 ifeq ($(strip $(DEBOUNCE_TYPE)),sym_g)
     DEBOUNCE_TYPE:=sym_defer_g
@@ -454,6 +473,8 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
     # Determine which (if any) transport files are required
     ifneq ($(strip $(SPLIT_TRANSPORT)), custom)
         QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport.c
+        QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_objects.c
+        QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_events.c
         # Functions added via QUANTUM_LIB_SRC are only included in the final binary if they're called.
         # Unused functions are pruned away, which is why we can add multiple drivers here without bloat.
         ifeq ($(PLATFORM),AVR)
@@ -470,6 +491,10 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
         else
             QUANTUM_LIB_SRC += serial_$(strip $(SERIAL_DRIVER)).c
         endif
+        ifeq ($(strip $(SERIAL_DRIVER)), usart_duplex)
+            COMMON_VPATH += $(DRIVER_PATH)/serial_duplex
+            QUANTUM_LIB_SRC += serial_duplex.c
+        endif
     endif
     COMMON_VPATH += $(QUANTUM_PATH)/split_common
 endif
@@ -506,6 +531,15 @@ endif
 
 include $(DRIVER_PATH)/qwiic/qwiic.mk
 
+ifeq ($(strip $(I2C_QUEUE_ENABLE)), yes)
+    ifneq ($(PLATFORM),CHIBIOS)
+        $(error I2C_QUEUE_ENABLE is only supported on ChibiOS)
+    endif
+    OPT_DEFS += -DI2C_QUEUE_ENABLE
+    COMMON_VPATH += $(DRIVER_PATH)/i2c_queue
+    QUANTUM_LIB_SRC += i2c_master.c i2c_queue.c
+endif
+
 ifeq ($(strip $(UCIS_ENABLE)), yes)
     OPT_DEFS += -DUCIS_ENABLE
     UNICODE_COMMON := yes
@@ -22,7 +22,9 @@
 
 #pragma once
 
-#define I2C_SLAVE_REG_COUNT 30
+#ifndef I2C_SLAVE_REG_COUNT
+#    define I2C_SLAVE_REG_COUNT 30
+#endif
 
 extern volatile uint8_t i2c_slave_reg[I2C_SLAVE_REG_COUNT];
 
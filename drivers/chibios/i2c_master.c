@@ -28,6 +28,9 @@
 #include "i2c_master.h"
 #include <string.h>
 #include <hal.h>
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 
 static uint8_t i2c_address;
 
@@ -77,13 +80,58 @@ __attribute__((weak)) void i2c_init(void) {
     }
 }
 
+#ifdef I2C_QUEUE_ENABLE
+#    ifndef I2C_QUEUE_THREAD_PRIORITY
+#        define I2C_QUEUE_THREAD_PRIORITY (NORMALPRIO + 1)
+#    endif
+
+static THD_WORKING_AREA(waI2CQueueThread, 256);
+static binary_semaphore_t i2c_queue_kick_sem;
+static binary_semaphore_t i2c_queue_done_sem;
+
+// Blocking transfers have to wait for the queue so they never share the bus with the worker
+#    define I2C_QUEUE_DRAIN() i2c_queue_flush()
+
+static THD_FUNCTION(I2CQueueThread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_queue");
+    while (true) {
+        chBSemWait(&i2c_queue_kick_sem);
+
+        i2c_queue_entry_t* entry;
+        while ((entry = i2c_queue_next()) != NULL) {
+            i2cStart(&I2C_DRIVER, &i2cconfig);
+            msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (entry->address >> 1), entry->data, entry->length, 0, 0, TIME_MS2I(entry->timeout));
+
+            i2c_queue_complete(entry, chibios_to_qmk(&status));
+            chBSemSignal(&i2c_queue_done_sem);
+        }
+    }
+}
+
+void i2c_queue_backend_init(void) {
+    i2c_init();
+    chBSemObjectInit(&i2c_queue_kick_sem, true);
+    chBSemObjectInit(&i2c_queue_done_sem, true);
+    chThdCreateStatic(waI2CQueueThread, sizeof(waI2CQueueThread), I2C_QUEUE_THREAD_PRIORITY, I2CQueueThread, NULL);
+}
+
+void i2c_queue_backend_kick(void) { chBSemSignal(&i2c_queue_kick_sem); }
+
+void i2c_queue_backend_wait(void) { chBSemWaitTimeout(&i2c_queue_done_sem, TIME_MS2I(1)); }
+#else
+#    define I2C_QUEUE_DRAIN()
+#endif
+
 i2c_status_t i2c_start(uint8_t address) {
+    I2C_QUEUE_DRAIN();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     return I2C_STATUS_SUCCESS;
 }
 
 i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    I2C_QUEUE_DRAIN();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
@@ -91,6 +139,7 @@ i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length,
 }
 
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    I2C_QUEUE_DRAIN();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
@@ -98,6 +147,7 @@ i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    I2C_QUEUE_DRAIN();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -112,10 +162,14 @@ i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data,
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    I2C_QUEUE_DRAIN();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
     return chibios_to_qmk(&status);
 }
 
-void i2c_stop(void) { i2cStop(&I2C_DRIVER); }
+void i2c_stop(void) {
+    I2C_QUEUE_DRAIN();
+    i2cStop(&I2C_DRIVER);
+}
@@ -0,0 +1,224 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+#include "serial.h"
+#include "serial_duplex.h"
+
+#include <ch.h>
+#include <hal.h>
+
+#ifndef USART_CR1_M0
+#    define USART_CR1_M0 USART_CR1_M  // some platforms (f1xx) dont have this so
+#endif
+
+#ifndef USE_GPIOV1
+// The default PAL alternate modes are used to signal that the pins are used for USART
+#    ifndef SERIAL_USART_TX_PAL_MODE
+#        define SERIAL_USART_TX_PAL_MODE 7
+#    endif
+#    ifndef SERIAL_USART_RX_PAL_MODE
+#        define SERIAL_USART_RX_PAL_MODE 7
+#    endif
+#endif
+
+#ifndef SERIAL_USART_DRIVER
+#    define SERIAL_USART_DRIVER UARTD1
+#endif
+
+#ifndef SERIAL_USART_CR1
+#    define SERIAL_USART_CR1 (USART_CR1_PCE | USART_CR1_PS | USART_CR1_M0)  // parity enable, odd parity, 9 bit length
+#endif
+
+#ifndef SERIAL_USART_CR2
+#    define SERIAL_USART_CR2 (USART_CR2_STOP_1)  // 2 stop bits
+#endif
+
+#ifndef SERIAL_USART_CR3
+#    define SERIAL_USART_CR3 0
+#endif
+
+#ifdef SOFT_SERIAL_PIN
+#    define SERIAL_USART_TX_PIN SOFT_SERIAL_PIN
+#endif
+
+#ifndef SERIAL_USART_RX_PIN
+#    error SERIAL_USART_RX_PIN must be defined for the full-duplex USART driver
+#endif
+
+#ifndef SELECT_SOFT_SERIAL_SPEED
+#    define SELECT_SOFT_SERIAL_SPEED 1
+#endif
+
+#ifdef SERIAL_USART_SPEED
+// Allow advanced users to directly set SERIAL_USART_SPEED
+#elif SELECT_SOFT_SERIAL_SPEED == 0
+#    define SERIAL_USART_SPEED 460800
+#elif SELECT_SOFT_SERIAL_SPEED == 1
+#    define SERIAL_USART_SPEED 230400
+#elif SELECT_SOFT_SERIAL_SPEED == 2
+#    define SERIAL_USART_SPEED 115200
+#elif SELECT_SOFT_SERIAL_SPEED == 3
+#    define SERIAL_USART_SPEED 57600
+#elif SELECT_SOFT_SERIAL_SPEED == 4
+#    define SERIAL_USART_SPEED 38400
+#elif SELECT_SOFT_SERIAL_SPEED == 5
+#    define SERIAL_USART_SPEED 19200
+#else
+#    error invalid SELECT_SOFT_SERIAL_SPEED value
+#endif
+
+#ifndef SERIAL_USART_RX_BUFFER_SIZE
+#    define SERIAL_USART_RX_BUFFER_SIZE 128
+#endif
+
+// How often the slave checks its buffers for changes to push, in ms
+#ifndef SERIAL_USART_STREAM_INTERVAL
+#    define SERIAL_USART_STREAM_INTERVAL 1
+#endif
+
+static serial_duplex_t duplex_link;
+
+// Received bytes arrive one at a time from the driver's idle DMA loop
+static uint8_t rx_ring[SERIAL_USART_RX_BUFFER_SIZE];
+static INPUTQUEUE_DECL(rx_queue, rx_ring, sizeof(rx_ring), NULL, NULL);
+
+// Frames are sent straight out of this buffer by DMA
+static uint8_t            tx_buffer[SERIAL_DUPLEX_MAX_PAYLOAD + SERIAL_DUPLEX_OVERHEAD];
+static binary_semaphore_t tx_done;
+
+static void receive_char(UARTDriver *uartp, uint16_t c) {
+    (void)uartp;
+    osalSysLockFromISR();
+    iqPutI(&rx_queue, (uint8_t)c);  // on overrun the frame checksum catches the gap
+    osalSysUnlockFromISR();
+}
+
+static void transmit_done(UARTDriver *uartp) {
+    (void)uartp;
+    osalSysLockFromISR();
+    chBSemSignalI(&tx_done);
+    osalSysUnlockFromISR();
+}
+
+static UARTConfig uart_config = {
+    .txend1_cb = transmit_done,
+    .rxchar_cb = receive_char,
+    .speed     = (SERIAL_USART_SPEED),
+    .cr1       = (SERIAL_USART_CR1),
+    .cr2       = (SERIAL_USART_CR2),
+    .cr3       = (SERIAL_USART_CR3),
+};
+
+void serial_duplex_backend_send(serial_duplex_t *link, const uint8_t *frame, uint8_t length) {
+    (void)link;
+    // Only ever one frame on the wire, the next one waits for the DMA to let go of the buffer
+    chBSemWait(&tx_done);
+    memcpy(tx_buffer, frame, length);
+    uartStartSend(&SERIAL_USART_DRIVER, length, tx_buffer);
+}
+
+void serial_duplex_backend_poll(serial_duplex_t *link, uint16_t timeout) {
+    uint8_t buffer[16];
+
+    msg_t first = iqGetTimeout(&rx_queue, timeout ? TIME_MS2I(timeout) : TIME_IMMEDIATE);
+    if (first < MSG_OK) {
+        return;
+    }
+
+    buffer[0]    = (uint8_t)first;
+    size_t count = 1 + iqReadTimeout(&rx_queue, &buffer[1], sizeof(buffer) - 1, TIME_IMMEDIATE);
+    while (count) {
+        serial_duplex_receive(link, buffer, count);
+        count = iqReadTimeout(&rx_queue, buffer, sizeof(buffer), TIME_IMMEDIATE);
+    }
+}
+
+/*
+ * This thread runs on the slave, answering the master's requests and
+ * pushing its buffers whenever they change
+ */
+static THD_WORKING_AREA(waSlaveThread, 2048);
+static THD_FUNCTION(SlaveThread, arg) {
+    (void)arg;
+    chRegSetThreadName("slave_transport");
+
+    while (true) {
+        serial_duplex_backend_poll(&duplex_link, SERIAL_USART_STREAM_INTERVAL);
+        serial_duplex_stream(&duplex_link);
+    }
+}
+
+__attribute__((weak)) void usart_init(void) {
+#if defined(USE_GPIOV1)
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_STM32_ALTERNATE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_INPUT_PULLUP);
+#else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_STM32_OTYPE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_RX_PAL_MODE) | PAL_STM32_PUPDR_PULLUP);
+#endif
+}
+
+static void usart_start(void) {
+    usart_init();
+
+    chBSemObjectInit(&tx_done, false);
+    uartStart(&SERIAL_USART_DRIVER, &uart_config);
+}
+
+void soft_serial_initiator_init(SSTD_t *sstd_table, int sstd_table_size) {
+    serial_duplex_init(&duplex_link, sstd_table, (uint8_t)sstd_table_size, true);
+    usart_start();
+}
+
+void soft_serial_target_init(SSTD_t *sstd_table, int sstd_table_size) {
+    serial_duplex_init(&duplex_link, sstd_table, (uint8_t)sstd_table_size, false);
+    usart_start();
+
+    // Start transport thread
+    chThdCreateStatic(waSlaveThread, sizeof(waSlaveThread), HIGHPRIO, SlaveThread, NULL);
+}
+
+/////////
+//  start transaction by initiator
+//
+// int  soft_serial_transaction(int sstd_index)
+//
+// Returns:
+//    TRANSACTION_END
+//    TRANSACTION_NO_RESPONSE
+//    TRANSACTION_TYPE_ERROR
+#ifndef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_transaction(void) {
+    uint8_t sstd_index = 0;
+#else
+int soft_serial_transaction(int index) {
+    uint8_t sstd_index = index;
+#endif
+
+    return serial_duplex_transaction(&duplex_link, sstd_index);
+}
+
+#ifdef SERIAL_USE_MULTI_TRANSACTION
+int soft_serial_get_and_clean_status(int sstd_index) {
+    SSTD_t *trans = &duplex_link.table[sstd_index];
+    osalSysLock();
+    int retval     = *trans->status;
+    *trans->status = 0;
+    osalSysUnlock();
+    return retval;
+}
+#endif
@@ -19,6 +19,22 @@
 
 #include "eeprom_driver.h"
 
+#if defined(EEPROM_I2C)
+#    include "eeprom_i2c.h"
+#elif defined(EEPROM_SPI)
+#    include "eeprom_spi.h"
+#endif
+
+// eeprom_update_block() compares and rewrites the target in chunks of this size,
+// aligned to it, so that only the pages that actually changed get written.
+#ifndef EEPROM_DRIVER_UPDATE_CHUNK_SIZE
+#    ifdef EXTERNAL_EEPROM_PAGE_SIZE
+#        define EEPROM_DRIVER_UPDATE_CHUNK_SIZE EXTERNAL_EEPROM_PAGE_SIZE
+#    else
+#        define EEPROM_DRIVER_UPDATE_CHUNK_SIZE 32
+#    endif
+#endif
+
 uint8_t eeprom_read_byte(const uint8_t *addr) {
     uint8_t ret = 0;
     eeprom_read_block(&ret, addr, 1);
@@ -44,10 +60,34 @@ void eeprom_write_word(uint16_t *addr, uint16_t value) { eeprom_write_block(&val
 void eeprom_write_dword(uint32_t *addr, uint32_t value) { eeprom_write_block(&value, addr, 4); }
 
 void eeprom_update_block(const void *buf, void *addr, size_t len) {
-    uint8_t read_buf[len];
-    eeprom_read_block(read_buf, addr, len);
-    if (memcmp(buf, read_buf, len) != 0) {
-        eeprom_write_block(buf, addr, len);
+    uint8_t        read_buf[EEPROM_DRIVER_UPDATE_CHUNK_SIZE];
+    const uint8_t *src         = (const uint8_t *)buf;
+    uintptr_t      target_addr = (uintptr_t)addr;
+
+    while (len > 0) {
+        size_t chunk_length = EEPROM_DRIVER_UPDATE_CHUNK_SIZE - (target_addr % EEPROM_DRIVER_UPDATE_CHUNK_SIZE);
+        if (chunk_length > len) {
+            chunk_length = len;
+        }
+
+        eeprom_read_block(read_buf, (const void *)target_addr, chunk_length);
+
+        // Only write the span between the first and last differing byte
+        size_t first = 0;
+        while (first < chunk_length && read_buf[first] == src[first]) {
+            first++;
+        }
+        if (first < chunk_length) {
+            size_t last = chunk_length;
+            while (read_buf[last - 1] == src[last - 1]) {
+                last--;
+            }
+            eeprom_write_block(src + first, (void *)(target_addr + first), last - first);
+        }
+
+        src += chunk_length;
+        target_addr += chunk_length;
+        len -= chunk_length;
     }
 }
 
@@ -0,0 +1,83 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "eeprom_driver.h"
+#include "eeprom_transient_counting.h"
+}
+
+// Same size as the dynamic keymap of a 4 layer, 5x15 board
+#define KEYMAP_SIZE (4 * 5 * 15 * 2)
+
+class EepromDriverTest : public ::testing::Test {
+   protected:
+    uint8_t keymap[KEYMAP_SIZE];
+
+    void SetUp() override {
+        eeprom_driver_init();
+        for (int i = 0; i < KEYMAP_SIZE; i++) {
+            keymap[i] = i * 7;
+        }
+        eeprom_reset_transactions();
+    }
+};
+
+TEST_F(EepromDriverTest, TestUpdateBlockWritesData) {
+    uint8_t read_back[KEYMAP_SIZE];
+    eeprom_update_block(keymap, (void *)100, KEYMAP_SIZE);
+    eeprom_read_block(read_back, (void *)100, KEYMAP_SIZE);
+    EXPECT_EQ(memcmp(keymap, read_back, KEYMAP_SIZE), 0);
+}
+
+TEST_F(EepromDriverTest, TestUpdateBlockSkipsUnchangedData) {
+    eeprom_update_block(keymap, (void *)0, KEYMAP_SIZE);
+    eeprom_reset_transactions();
+    eeprom_update_block(keymap, (void *)0, KEYMAP_SIZE);
+    EXPECT_EQ(eeprom_write_transactions, 0u);
+}
+
+TEST_F(EepromDriverTest, TestUpdateBlockOnlyWritesChangedSpan) {
+    eeprom_update_block(keymap, (void *)0, KEYMAP_SIZE);
+    keymap[40]++;
+    keymap[45]++;
+    keymap[300]++;
+    eeprom_reset_transactions();
+    eeprom_update_block(keymap, (void *)0, KEYMAP_SIZE);
+    EXPECT_EQ(eeprom_write_transactions, 2u);
+    EXPECT_EQ(eeprom_bytes_written, 7u);
+}
+
+TEST_F(EepromDriverTest, TestBlockSyncUsesFewerTransactionsThanBytes) {
+    for (int i = 0; i < KEYMAP_SIZE; i++) {
+        eeprom_update_byte((uint8_t *)(uintptr_t)i, keymap[i]);
+    }
+    uint32_t per_byte = eeprom_read_transactions + eeprom_write_transactions;
+
+    eeprom_driver_erase();
+    eeprom_reset_transactions();
+    eeprom_update_block(keymap, (void *)0, KEYMAP_SIZE);
+    uint32_t per_block = eeprom_read_transactions + eeprom_write_transactions;
+
+    uint8_t read_back[KEYMAP_SIZE];
+    eeprom_reset_transactions();
+    eeprom_read_block(read_back, (void *)0, KEYMAP_SIZE);
+    EXPECT_EQ(eeprom_read_transactions, 1u);
+    EXPECT_EQ(memcmp(keymap, read_back, KEYMAP_SIZE), 0);
+
+    EXPECT_LT(per_block * 10, per_byte);
+}
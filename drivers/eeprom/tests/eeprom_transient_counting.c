@@ -0,0 +1,48 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Builds the transient backend under other names and puts a counting layer
+ * in front of it, so every eeprom_read_block()/eeprom_write_block() call
+ * stands for one bus transaction of a real external EEPROM.
+ */
+#define eeprom_read_block transient_eeprom_read_block
+#define eeprom_write_block transient_eeprom_write_block
+#include "eeprom_transient.c"
+#undef eeprom_read_block
+#undef eeprom_write_block
+
+#include "eeprom_transient_counting.h"
+
+uint32_t eeprom_read_transactions  = 0;
+uint32_t eeprom_write_transactions = 0;
+uint32_t eeprom_bytes_written      = 0;
+
+void eeprom_reset_transactions(void) {
+    eeprom_read_transactions  = 0;
+    eeprom_write_transactions = 0;
+    eeprom_bytes_written      = 0;
+}
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    eeprom_read_transactions++;
+    transient_eeprom_read_block(buf, addr, len);
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    eeprom_write_transactions++;
+    eeprom_bytes_written += len;
+    transient_eeprom_write_block(buf, addr, len);
+}
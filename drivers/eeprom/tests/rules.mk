@@ -0,0 +1,9 @@
+eeprom_driver_DEFS := -DEEPROM_DRIVER -DEEPROM_TRANSIENT -DTRANSIENT_EEPROM_SIZE=1024
+
+eeprom_driver_INC := \
+	$(DRIVER_PATH)/eeprom
+
+eeprom_driver_SRC := \
+	$(DRIVER_PATH)/eeprom/tests/eeprom_transient_counting.c \
+	$(DRIVER_PATH)/eeprom/tests/eeprom_driver_tests.cpp \
+	$(DRIVER_PATH)/eeprom/eeprom_driver.c
@@ -0,0 +1,152 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "i2c_queue.h"
+#include <string.h>
+
+/* The ring is split between two contexts without a lock: the main loop owns
+ * queue_tail and queue_head and only moves slots FREE -> QUEUED and
+ * DONE -> FREE, the backend owns queue_worker and only moves slots
+ * QUEUED -> ACTIVE -> DONE. A slot's contents are written before its state,
+ * so the compiler barrier is enough on a single core.
+ */
+#define I2C_QUEUE_BARRIER() __asm__ volatile("" ::: "memory")
+
+static i2c_queue_entry_t queue[I2C_QUEUE_LENGTH];
+static uint8_t           queue_head;    // oldest slot not yet retired
+static uint8_t           queue_tail;    // next slot to fill
+static uint8_t           queue_worker;  // next slot for the backend
+static bool              queue_initialised;
+static i2c_queue_stats_t queue_stats;
+
+static inline uint8_t queue_advance(uint8_t index) { return (index + 1) % I2C_QUEUE_LENGTH; }
+
+i2c_status_t i2c_queue_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_queue_callback_t callback, void *arg) {
+    if (length >= I2C_QUEUE_TRANSFER_SIZE) {
+        return I2C_STATUS_ERROR;
+    }
+
+    if (!queue_initialised) {
+        queue_initialised = true;
+        i2c_queue_backend_init();
+    }
+
+    i2c_queue_entry_t *entry = &queue[queue_tail];
+    if (entry->state != I2C_QUEUE_FREE) {
+        queue_stats.waits++;
+        do {
+            i2c_queue_task();
+            if (entry->state != I2C_QUEUE_FREE) {
+                i2c_queue_backend_wait();
+            }
+        } while (entry->state != I2C_QUEUE_FREE);
+    }
+
+    entry->address  = devaddr;
+    entry->timeout  = timeout;
+    entry->callback = callback;
+    entry->arg      = arg;
+    entry->status   = I2C_STATUS_SUCCESS;
+    entry->data[0]  = regaddr;
+    memcpy(&entry->data[1], data, length);
+    entry->length = length + 1;
+    I2C_QUEUE_BARRIER();
+    entry->state = I2C_QUEUE_QUEUED;
+
+    queue_tail = queue_advance(queue_tail);
+    queue_stats.submitted++;
+    i2c_queue_backend_kick();
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_queue_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_queue_callback_t callback, void *arg) {
+    if (length == 0) {
+        return I2C_STATUS_ERROR;
+    }
+    return i2c_queue_writeReg(address, data[0], &data[1], length - 1, timeout, callback, arg);
+}
+
+bool i2c_queue_busy(void) {
+    for (uint8_t i = 0; i < I2C_QUEUE_LENGTH; i++) {
+        if (queue[i].state != I2C_QUEUE_FREE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t i2c_queue_pending(uint8_t address) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < I2C_QUEUE_LENGTH; i++) {
+        uint8_t state = queue[i].state;
+        if ((state == I2C_QUEUE_QUEUED || state == I2C_QUEUE_ACTIVE) && queue[i].address == address) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint8_t i2c_queue_free(void) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < I2C_QUEUE_LENGTH; i++) {
+        if (queue[i].state == I2C_QUEUE_FREE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void i2c_queue_task(void) {
+    while (queue[queue_head].state == I2C_QUEUE_DONE) {
+        i2c_queue_entry_t *entry = &queue[queue_head];
+        I2C_QUEUE_BARRIER();
+        if (entry->status != I2C_STATUS_SUCCESS) {
+            queue_stats.failed++;
+        }
+        if (entry->callback) {
+            entry->callback(entry->address, entry->status, entry->arg);
+        }
+        entry->state = I2C_QUEUE_FREE;
+        queue_head   = queue_advance(queue_head);
+    }
+}
+
+void i2c_queue_flush(void) {
+    i2c_queue_task();
+    while (i2c_queue_busy()) {
+        i2c_queue_backend_wait();
+        i2c_queue_task();
+    }
+}
+
+const i2c_queue_stats_t *i2c_queue_get_stats(void) { return &queue_stats; }
+
+i2c_queue_entry_t *i2c_queue_next(void) {
+    i2c_queue_entry_t *entry = &queue[queue_worker];
+    if (entry->state != I2C_QUEUE_QUEUED) {
+        return NULL;
+    }
+    I2C_QUEUE_BARRIER();
+    entry->state = I2C_QUEUE_ACTIVE;
+    return entry;
+}
+
+void i2c_queue_complete(i2c_queue_entry_t *entry, i2c_status_t status) {
+    entry->status = status;
+    I2C_QUEUE_BARRIER();
+    entry->state = I2C_QUEUE_DONE;
+    queue_worker = queue_advance(queue_worker);
+}
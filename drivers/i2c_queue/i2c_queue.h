@@ -0,0 +1,91 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Non-blocking I2C write queue.
+ *
+ * Transfers are copied into a fixed ring of slots and sent in the background
+ * by the platform backend, so the main loop can keep scanning while LED and
+ * display data is on the bus. Completion callbacks run from i2c_queue_task(),
+ * never from the backend's context, and must not issue blocking I2C calls.
+ * As with i2c_master, addresses are expected to be already shifted (addr << 1).
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+
+#ifndef I2C_QUEUE_LENGTH
+#    define I2C_QUEUE_LENGTH 16
+#endif
+
+#if I2C_QUEUE_LENGTH > 255
+#    error "I2C_QUEUE_LENGTH must not exceed 255"
+#endif
+
+// Room for an OLED block or an ISSI PWM transfer plus the register byte
+#ifndef I2C_QUEUE_TRANSFER_SIZE
+#    define I2C_QUEUE_TRANSFER_SIZE 40
+#endif
+
+typedef void (*i2c_queue_callback_t)(uint8_t address, i2c_status_t status, void *arg);
+
+typedef enum {
+    I2C_QUEUE_FREE,
+    I2C_QUEUE_QUEUED,
+    I2C_QUEUE_ACTIVE,
+    I2C_QUEUE_DONE,
+} i2c_queue_state_t;
+
+typedef struct {
+    volatile uint8_t      state;
+    uint8_t               address;
+    uint8_t               length;
+    uint16_t              timeout;
+    volatile i2c_status_t status;
+    i2c_queue_callback_t  callback;
+    void *                arg;
+    uint8_t               data[I2C_QUEUE_TRANSFER_SIZE];
+} i2c_queue_entry_t;
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t failed;
+    uint32_t waits;  // submissions that had to wait for a free slot
+} i2c_queue_stats_t;
+
+i2c_status_t i2c_queue_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_queue_callback_t callback, void *arg);
+i2c_status_t i2c_queue_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout, i2c_queue_callback_t callback, void *arg);
+bool         i2c_queue_busy(void);
+uint8_t      i2c_queue_pending(uint8_t address);
+uint8_t      i2c_queue_free(void);
+void         i2c_queue_flush(void);
+void         i2c_queue_task(void);
+
+const i2c_queue_stats_t *i2c_queue_get_stats(void);
+
+/* Backend interface.
+ *
+ * The backend pulls transfers with i2c_queue_next() and reports each one
+ * through i2c_queue_complete(), in order, from a single context.
+ */
+i2c_queue_entry_t *i2c_queue_next(void);
+void               i2c_queue_complete(i2c_queue_entry_t *entry, i2c_status_t status);
+
+void i2c_queue_backend_init(void);
+void i2c_queue_backend_kick(void);  // a transfer was queued
+void i2c_queue_backend_wait(void);  // sleep until a transfer may have completed
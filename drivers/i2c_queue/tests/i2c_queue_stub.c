@@ -0,0 +1,75 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Host backend for the I2C queue.
+ *
+ * Nothing runs in the background: transfers are only "sent" when a test calls
+ * i2c_queue_stub_run(), or when the queue itself waits for a free slot, which
+ * stands in for the worker thread getting scheduled.
+ */
+#include "i2c_queue_stub.h"
+#include <string.h>
+
+i2c_queue_stub_transfer_t i2c_queue_stub_log[I2C_QUEUE_STUB_LOG_SIZE];
+uint16_t                  i2c_queue_stub_log_count;
+uint16_t                  i2c_queue_stub_kicks;
+uint16_t                  i2c_queue_stub_waits;
+
+static uint8_t stub_fail_count;
+
+void i2c_queue_stub_reset(void) {
+    // Let the previous test's transfers drain before clearing the counters
+    i2c_queue_flush();
+    memset(i2c_queue_stub_log, 0, sizeof(i2c_queue_stub_log));
+    i2c_queue_stub_log_count = 0;
+    i2c_queue_stub_kicks     = 0;
+    i2c_queue_stub_waits     = 0;
+    stub_fail_count          = 0;
+}
+
+void i2c_queue_stub_fail_next(uint8_t count) { stub_fail_count = count; }
+
+uint16_t i2c_queue_stub_run(uint16_t count) {
+    uint16_t           sent = 0;
+    i2c_queue_entry_t *entry;
+    while (sent < count && (entry = i2c_queue_next()) != NULL) {
+        if (i2c_queue_stub_log_count < I2C_QUEUE_STUB_LOG_SIZE) {
+            i2c_queue_stub_transfer_t *transfer = &i2c_queue_stub_log[i2c_queue_stub_log_count++];
+            transfer->address                   = entry->address;
+            transfer->length                    = entry->length;
+            memcpy(transfer->data, entry->data, entry->length);
+        }
+
+        i2c_status_t status = I2C_STATUS_SUCCESS;
+        if (stub_fail_count) {
+            stub_fail_count--;
+            status = I2C_STATUS_TIMEOUT;
+        }
+        i2c_queue_complete(entry, status);
+        sent++;
+    }
+    return sent;
+}
+
+void i2c_queue_backend_init(void) {}
+
+void i2c_queue_backend_kick(void) { i2c_queue_stub_kicks++; }
+
+void i2c_queue_backend_wait(void) {
+    i2c_queue_stub_waits++;
+    i2c_queue_stub_run(1);
+}
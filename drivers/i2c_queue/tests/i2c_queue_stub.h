@@ -0,0 +1,39 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_queue.h"
+
+#define I2C_QUEUE_STUB_LOG_SIZE 64
+
+typedef struct {
+    uint8_t address;
+    uint8_t length;
+    uint8_t data[I2C_QUEUE_TRANSFER_SIZE];
+} i2c_queue_stub_transfer_t;
+
+extern i2c_queue_stub_transfer_t i2c_queue_stub_log[I2C_QUEUE_STUB_LOG_SIZE];
+extern uint16_t                  i2c_queue_stub_log_count;
+extern uint16_t                  i2c_queue_stub_kicks;
+extern uint16_t                  i2c_queue_stub_waits;
+
+void     i2c_queue_stub_reset(void);
+void     i2c_queue_stub_fail_next(uint8_t count);
+uint16_t i2c_queue_stub_run(uint16_t count);
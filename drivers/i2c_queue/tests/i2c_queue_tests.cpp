@@ -0,0 +1,190 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "i2c_queue.h"
+#include "i2c_queue_stub.h"
+}
+
+#define LED_DRIVER_ADDR (0x50 << 1)
+#define OLED_ADDR (0x3C << 1)
+
+// Unlock, page select and twelve PWM chunks
+#define IS31FL3733_FRAME_TRANSFERS 14
+
+struct completion_t {
+    uint8_t      address;
+    i2c_status_t status;
+    uintptr_t    arg;
+};
+
+static completion_t completions[I2C_QUEUE_STUB_LOG_SIZE];
+static uint8_t      completion_count;
+
+static void record_completion(uint8_t address, i2c_status_t status, void *arg) {
+    completions[completion_count++] = {address, status, (uintptr_t)arg};
+}
+
+class I2cQueueTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        i2c_queue_stub_reset();
+        completion_count = 0;
+    }
+};
+
+TEST_F(I2cQueueTest, TestTransmitIsDeferredAndCopied) {
+    uint8_t data[] = {0x00, 0x21, 0x00, 0x7F};
+    EXPECT_EQ(i2c_queue_transmit(OLED_ADDR, data, sizeof(data), 100, record_completion, (void *)1), I2C_STATUS_SUCCESS);
+    EXPECT_TRUE(i2c_queue_busy());
+    EXPECT_EQ(i2c_queue_stub_kicks, 1);
+    EXPECT_EQ(i2c_queue_stub_log_count, 0);
+
+    // The caller's buffer can be reused straight away
+    data[1] = 0xFF;
+    EXPECT_EQ(i2c_queue_stub_run(10), 1);
+    ASSERT_EQ(i2c_queue_stub_log_count, 1);
+    EXPECT_EQ(i2c_queue_stub_log[0].address, OLED_ADDR);
+    EXPECT_EQ(i2c_queue_stub_log[0].length, sizeof(data));
+    EXPECT_EQ(i2c_queue_stub_log[0].data[1], 0x21);
+
+    // Callbacks only run from the main loop task
+    EXPECT_EQ(completion_count, 0);
+    i2c_queue_task();
+    ASSERT_EQ(completion_count, 1);
+    EXPECT_EQ(completions[0].address, OLED_ADDR);
+    EXPECT_EQ(completions[0].status, I2C_STATUS_SUCCESS);
+    EXPECT_EQ(completions[0].arg, 1u);
+    EXPECT_FALSE(i2c_queue_busy());
+}
+
+TEST_F(I2cQueueTest, TestWriteRegPrependsRegister) {
+    uint8_t pwm[16];
+    for (uint8_t i = 0; i < sizeof(pwm); i++) {
+        pwm[i] = i + 1;
+    }
+    EXPECT_EQ(i2c_queue_writeReg(LED_DRIVER_ADDR, 0x20, pwm, sizeof(pwm), 100, NULL, NULL), I2C_STATUS_SUCCESS);
+    i2c_queue_stub_run(1);
+    ASSERT_EQ(i2c_queue_stub_log_count, 1);
+    EXPECT_EQ(i2c_queue_stub_log[0].length, 17);
+    EXPECT_EQ(i2c_queue_stub_log[0].data[0], 0x20);
+    EXPECT_EQ(0, memcmp(&i2c_queue_stub_log[0].data[1], pwm, sizeof(pwm)));
+}
+
+TEST_F(I2cQueueTest, TestDevicesAreSentInSubmissionOrder) {
+    uint8_t reg[] = {0xFD, 0x01};
+    i2c_queue_transmit(LED_DRIVER_ADDR, reg, sizeof(reg), 100, record_completion, (void *)0);
+    i2c_queue_transmit(OLED_ADDR, reg, sizeof(reg), 100, record_completion, (void *)1);
+    i2c_queue_transmit(LED_DRIVER_ADDR, reg, sizeof(reg), 100, record_completion, (void *)2);
+    EXPECT_EQ(i2c_queue_pending(LED_DRIVER_ADDR), 2);
+    EXPECT_EQ(i2c_queue_pending(OLED_ADDR), 1);
+
+    i2c_queue_stub_run(1);
+    EXPECT_EQ(i2c_queue_pending(LED_DRIVER_ADDR), 1);
+    EXPECT_EQ(i2c_queue_pending(OLED_ADDR), 1);
+
+    i2c_queue_stub_run(2);
+    i2c_queue_task();
+    ASSERT_EQ(completion_count, 3);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_EQ(completions[i].arg, i);
+    }
+    EXPECT_EQ(i2c_queue_stub_log[1].address, OLED_ADDR);
+    EXPECT_EQ(i2c_queue_pending(LED_DRIVER_ADDR), 0);
+}
+
+TEST_F(I2cQueueTest, TestFullQueueWaitsForSlot) {
+    uint8_t  reg[] = {0x00, 0x00};
+    uint32_t waits = i2c_queue_get_stats()->waits;
+    for (uint8_t i = 0; i < I2C_QUEUE_LENGTH; i++) {
+        i2c_queue_transmit(LED_DRIVER_ADDR, reg, sizeof(reg), 100, record_completion, (void *)(uintptr_t)i);
+    }
+    EXPECT_EQ(i2c_queue_stub_waits, 0);
+
+    // One more has to wait for the oldest transfer to finish and be retired
+    i2c_queue_transmit(LED_DRIVER_ADDR, reg, sizeof(reg), 100, record_completion, (void *)(uintptr_t)I2C_QUEUE_LENGTH);
+    EXPECT_EQ(i2c_queue_stub_waits, 1);
+    EXPECT_EQ(i2c_queue_get_stats()->waits, waits + 1);
+    ASSERT_EQ(completion_count, 1);
+    EXPECT_EQ(completions[0].arg, 0u);
+    EXPECT_EQ(i2c_queue_pending(LED_DRIVER_ADDR), I2C_QUEUE_LENGTH);
+}
+
+TEST_F(I2cQueueTest, TestQueueHoldsEveryDriverFrame) {
+    uint8_t  pwm[16] = {0};
+    uint8_t  reg[]   = {0xFE, 0xC5};
+    uint32_t waits   = i2c_queue_get_stats()->waits;
+    EXPECT_EQ(i2c_queue_free(), I2C_QUEUE_LENGTH);
+
+    // A full frame for both drivers goes in without waiting on the bus
+    for (uint8_t driver = 0; driver < DRIVER_COUNT; driver++) {
+        i2c_queue_transmit(LED_DRIVER_ADDR + (driver << 1), reg, sizeof(reg), 100, NULL, NULL);
+        i2c_queue_transmit(LED_DRIVER_ADDR + (driver << 1), reg, sizeof(reg), 100, NULL, NULL);
+        for (uint8_t chunk = 0; chunk < 12; chunk++) {
+            i2c_queue_writeReg(LED_DRIVER_ADDR + (driver << 1), chunk * 16, pwm, sizeof(pwm), 100, NULL, NULL);
+        }
+    }
+    EXPECT_EQ(i2c_queue_stub_waits, 0);
+    EXPECT_EQ(i2c_queue_free(), I2C_QUEUE_LENGTH - DRIVER_COUNT * IS31FL3733_FRAME_TRANSFERS);
+
+    // The rest of the ring is still usable, and only the one past it waits
+    while (i2c_queue_free()) {
+        i2c_queue_transmit(OLED_ADDR, reg, sizeof(reg), 100, NULL, NULL);
+    }
+    EXPECT_EQ(i2c_queue_stub_waits, 0);
+    EXPECT_EQ(i2c_queue_get_stats()->waits, waits);
+    i2c_queue_transmit(OLED_ADDR, reg, sizeof(reg), 100, NULL, NULL);
+    EXPECT_EQ(i2c_queue_stub_waits, 1);
+    EXPECT_EQ(i2c_queue_free(), 0);
+
+    i2c_queue_flush();
+    EXPECT_EQ(i2c_queue_free(), I2C_QUEUE_LENGTH);
+    EXPECT_EQ(i2c_queue_stub_log_count, I2C_QUEUE_LENGTH + 1);
+}
+
+TEST_F(I2cQueueTest, TestFailureIsReported) {
+    uint8_t  reg[]  = {0x00, 0x00};
+    uint32_t failed = i2c_queue_get_stats()->failed;
+    i2c_queue_stub_fail_next(1);
+    i2c_queue_transmit(LED_DRIVER_ADDR, reg, sizeof(reg), 100, record_completion, (void *)0);
+    i2c_queue_transmit(LED_DRIVER_ADDR, reg, sizeof(reg), 100, record_completion, (void *)1);
+    i2c_queue_flush();
+    ASSERT_EQ(completion_count, 2);
+    EXPECT_EQ(completions[0].status, I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(completions[1].status, I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_queue_get_stats()->failed, failed + 1);
+}
+
+TEST_F(I2cQueueTest, TestOversizedTransferIsRejected) {
+    uint8_t data[I2C_QUEUE_TRANSFER_SIZE + 1] = {0};
+    EXPECT_EQ(i2c_queue_transmit(OLED_ADDR, data, sizeof(data), 100, record_completion, NULL), I2C_STATUS_ERROR);
+    EXPECT_EQ(i2c_queue_writeReg(OLED_ADDR, 0x40, data, I2C_QUEUE_TRANSFER_SIZE, 100, record_completion, NULL), I2C_STATUS_ERROR);
+    EXPECT_EQ(i2c_queue_transmit(OLED_ADDR, data, I2C_QUEUE_TRANSFER_SIZE, 100, record_completion, NULL), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(i2c_queue_stub_kicks, 1);
+}
+
+TEST_F(I2cQueueTest, TestFlushDrainsEverything) {
+    uint8_t reg[] = {0x00, 0x00};
+    for (uint8_t i = 0; i < 5; i++) {
+        i2c_queue_transmit(OLED_ADDR, reg, sizeof(reg), 100, record_completion, NULL);
+    }
+    i2c_queue_flush();
+    EXPECT_FALSE(i2c_queue_busy());
+    EXPECT_EQ(completion_count, 5);
+    EXPECT_EQ(i2c_queue_stub_log_count, 5);
+}
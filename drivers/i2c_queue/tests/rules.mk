@@ -0,0 +1,11 @@
+# Size the queue the way the docs suggest for a two driver IS31FL3733 board
+i2c_queue_DEFS := -DDRIVER_COUNT=2 -DI2C_QUEUE_LENGTH=32
+
+i2c_queue_INC := \
+	$(DRIVER_PATH)/i2c_queue/tests \
+	$(DRIVER_PATH)/i2c_queue
+
+i2c_queue_SRC := \
+	$(DRIVER_PATH)/i2c_queue/tests/i2c_queue_stub.c \
+	$(DRIVER_PATH)/i2c_queue/tests/i2c_queue_tests.cpp \
+	$(DRIVER_PATH)/i2c_queue/i2c_queue.c
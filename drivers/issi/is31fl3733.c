@@ -19,6 +19,16 @@
 #include "is31fl3733.h"
 #include "i2c_master.h"
 #include "wait.h"
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+
+// Unlock, page select and up to twelve PWM chunks
+#    define IS31FL3733_FRAME_TRANSFERS 14
+
+#    if I2C_QUEUE_LENGTH < IS31FL3733_FRAME_TRANSFERS
+#        error "I2C_QUEUE_LENGTH is too small for an IS31FL3733 frame"
+#    endif
+#endif
 
 // This is a 7-bit address, that gets left-shifted and bit 0
 // set to 0 for write, 1 for read (as per I2C protocol)
@@ -65,8 +75,8 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3733_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+uint8_t  g_pwm_buffer[DRIVER_COUNT][192];
+uint16_t g_pwm_buffer_dirty_chunks[DRIVER_COUNT] = {0};  // one bit per 16 byte transfer
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {{0}, {0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -90,37 +100,53 @@ bool IS31FL3733_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
     return true;
 }
 
-bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+static bool IS31FL3733_write_pwm_chunk(uint8_t addr, uint8_t *pwm_buffer, uint8_t chunk) {
     // Assumes PG1 is already selected.
-    // If any of the transactions fails function returns false.
-    // Transmit PWM registers in 12 transfers of 16 bytes.
-    // g_twi_transfer_buffer[] is 20 bytes
-
-    // Iterate over the pwm_buffer contents at 16 byte intervals.
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // Copy the data from i to i+15.
-        // Device will auto-increment register for data after the first byte
-        // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    // If the transaction fails function returns false.
+    uint8_t i = chunk * 16;
+
+    g_twi_transfer_buffer[0] = i;
+    // Copy the data from i to i+15.
+    // Device will auto-increment register for data after the first byte
+    // Thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer.
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
+    }
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
-                return false;
-            }
-        }
-#else
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
         if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
             return false;
         }
+    }
+#else
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) != 0) {
+        return false;
+    }
 #endif
+    return true;
+}
+
+bool IS31FL3733_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // Assumes PG1 is already selected.
+    // If any of the transactions fails function returns false.
+    // Transmit PWM registers in 12 transfers of 16 bytes.
+    // g_twi_transfer_buffer[] is 20 bytes
+    for (uint8_t chunk = 0; chunk < 12; chunk++) {
+        if (!IS31FL3733_write_pwm_chunk(addr, pwm_buffer, chunk)) {
+            return false;
+        }
     }
     return true;
 }
 
+static inline void IS31FL3733_set_pwm_register(uint8_t driver, uint8_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty_chunks[driver] |= (1 << (reg / 16));
+    }
+}
+
 void IS31FL3733_init(uint8_t addr, uint8_t sync) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -167,10 +193,9 @@ void IS31FL3733_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3733_set_pwm_register(led.driver, led.r, red);
+        IS31FL3733_set_pwm_register(led.driver, led.g, green);
+        IS31FL3733_set_pwm_register(led.driver, led.b, blue);
     }
 }
 
@@ -209,19 +234,69 @@ void IS31FL3733_set_led_control_register(uint8_t index, bool red, bool green, bo
     g_led_control_registers_update_required[led.driver] = true;
 }
 
+#ifdef I2C_QUEUE_ENABLE
+static void IS31FL3733_queue_register(uint8_t addr, uint8_t reg, uint8_t data) {
+    uint8_t packet[2] = {reg, data};
+    i2c_queue_transmit(addr << 1, packet, 2, ISSI_TIMEOUT, NULL, NULL);
+}
+
+static uint8_t IS31FL3733_frame_transfers(uint8_t index) {
+    uint8_t count = 2;
+    for (uint8_t chunk = 0; chunk < 12; chunk++) {
+        if (g_pwm_buffer_dirty_chunks[index] & (1 << chunk)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void IS31FL3733_pwm_chunk_done(uint8_t address, i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        // Resend the range with the next frame, and refresh PG0 as in the blocking path.
+        uint8_t index = (uintptr_t)arg >> 4;
+        uint8_t chunk = (uintptr_t)arg & 0x0F;
+        g_pwm_buffer_dirty_chunks[index] |= (1 << chunk);
+        g_led_control_registers_update_required[index] = true;
+    }
+}
+#endif
+
 void IS31FL3733_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
+#ifdef I2C_QUEUE_ENABLE
+    // While the previous frame is still on the bus, or the queue has no room
+    // for the whole frame, changes keep accumulating in the dirty mask and go
+    // out together with the next update instead of blocking the main loop.
+    if (g_pwm_buffer_dirty_chunks[index] && !i2c_queue_pending(addr << 1) && i2c_queue_free() >= IS31FL3733_frame_transfers(index)) {
+        IS31FL3733_queue_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
+        IS31FL3733_queue_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
+
+        for (uint8_t chunk = 0; chunk < 12; chunk++) {
+            if (g_pwm_buffer_dirty_chunks[index] & (1 << chunk)) {
+                g_pwm_buffer_dirty_chunks[index] &= ~(1 << chunk);
+                i2c_queue_writeReg(addr << 1, chunk * 16, &g_pwm_buffer[index][chunk * 16], 16, ISSI_TIMEOUT, IS31FL3733_pwm_chunk_done, (void *)(uintptr_t)((index << 4) | chunk));
+            }
+        }
+    }
+#else
+    if (g_pwm_buffer_dirty_chunks[index]) {
         // Firstly we need to unlock the command register and select PG1.
         IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3733_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        // If any of the transactions fail we risk writing dirty PG0,
-        // refresh page 0 just in case.
-        if (!IS31FL3733_write_pwm_buffer(addr, g_pwm_buffer[index])) {
-            g_led_control_registers_update_required[index] = true;
+        // Only the 16 byte ranges that changed since the last update are sent.
+        for (uint8_t chunk = 0; chunk < 12; chunk++) {
+            if (g_pwm_buffer_dirty_chunks[index] & (1 << chunk)) {
+                // If any of the transactions fail we risk writing dirty PG0,
+                // refresh page 0 just in case. Unsent ranges stay dirty.
+                if (!IS31FL3733_write_pwm_chunk(addr, g_pwm_buffer[index], chunk)) {
+                    g_led_control_registers_update_required[index] = true;
+                    break;
+                }
+                g_pwm_buffer_dirty_chunks[index] &= ~(1 << chunk);
+            }
         }
     }
-    g_pwm_buffer_update_required[index] = false;
+#endif
 }
 
 void IS31FL3733_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -15,6 +15,9 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "i2c_master.h"
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 #include "oled_driver.h"
 #include OLED_FONT_H
 #include "timer.h"
@@ -95,6 +98,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define I2C_TRANSMIT(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
 #define I2C_WRITE_REG(mode, data, size) i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
 
+// Render transfers go through the I2C queue when it is enabled, a failed
+// block is marked dirty again from the completion callback.
+#ifdef I2C_QUEUE_ENABLE
+_Static_assert(OLED_BLOCK_SIZE < I2C_QUEUE_TRANSFER_SIZE, "I2C_QUEUE_TRANSFER_SIZE must hold an OLED block and its control byte");
+static void oled_render_done(uint8_t address, i2c_status_t status, void *arg);
+#    define I2C_RENDER_TRANSMIT(data, block) i2c_queue_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT, oled_render_done, (void *)(uintptr_t)(block))
+#    define I2C_RENDER_WRITE_REG(mode, data, size, block) i2c_queue_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT, oled_render_done, (void *)(uintptr_t)(block))
+#else
+#    define I2C_RENDER_TRANSMIT(data, block) I2C_TRANSMIT(data)
+#    define I2C_RENDER_WRITE_REG(mode, data, size, block) I2C_WRITE_REG(mode, data, size)
+#endif
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
 // Display buffer's is the same as the OLED memory layout
@@ -270,11 +285,27 @@ static void rotate_90(const uint8_t *src, uint8_t *dest) {
     }
 }
 
+#ifdef I2C_QUEUE_ENABLE
+static void oled_render_done(uint8_t address, i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        print("oled_render transfer failed\n");
+        oled_dirty |= ((OLED_BLOCK_TYPE)1 << (uintptr_t)arg);
+    }
+}
+#endif
+
 void oled_render(void) {
     if (!oled_initialized) {
         return;
     }
 
+#ifdef I2C_QUEUE_ENABLE
+    // Keep a single block in flight so the queue never backs up into the main loop
+    if (i2c_queue_pending(OLED_DISPLAY_ADDRESS << 1)) {
+        return;
+    }
+#endif
+
     // Do we have work to do?
     oled_dirty &= OLED_ALL_BLOCKS_MASK;
     if (!oled_dirty || oled_scrolling) {
@@ -296,14 +327,14 @@ void oled_render(void) {
     }
 
     // Send column & page position
-    if (I2C_TRANSMIT(display_start) != I2C_STATUS_SUCCESS) {
+    if (I2C_RENDER_TRANSMIT(display_start, update_start) != I2C_STATUS_SUCCESS) {
         print("oled_render offset command failed\n");
         return;
     }
 
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
         // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        if (I2C_RENDER_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE, update_start) != I2C_STATUS_SUCCESS) {
             print("oled_render data failed\n");
             return;
         }
@@ -319,7 +350,7 @@ void oled_render(void) {
         }
 
         // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        if (I2C_RENDER_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE, update_start) != I2C_STATUS_SUCCESS) {
             print("oled_render90 data failed\n");
             return;
         }
@@ -0,0 +1,218 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serial_duplex.h"
+#include <string.h>
+#include "timer.h"
+
+// CRC-8, polynomial 0x07
+static uint8_t crc8_update(uint8_t crc, uint8_t data) {
+    crc ^= data;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t frame_checksum(uint8_t id, const uint8_t *payload, uint8_t length) {
+    uint8_t crc = crc8_update(0xFF, id);
+    crc         = crc8_update(crc, length);
+    for (uint8_t i = 0; i < length; i++) {
+        crc = crc8_update(crc, payload[i]);
+    }
+    return crc;
+}
+
+static uint8_t send_frame(serial_duplex_t *link, uint8_t id, const uint8_t *payload, uint8_t length) {
+    uint8_t frame[SERIAL_DUPLEX_MAX_PAYLOAD + SERIAL_DUPLEX_OVERHEAD];
+    uint8_t checksum = frame_checksum(id, payload, length);
+
+    frame[0] = SERIAL_DUPLEX_SOF;
+    frame[1] = id;
+    frame[2] = length;
+    memcpy(&frame[3], payload, length);
+    frame[3 + length] = checksum;
+
+    serial_duplex_backend_send(link, frame, length + SERIAL_DUPLEX_OVERHEAD);
+    link->stats.frames_sent++;
+    return checksum;
+}
+
+static bool transaction_fits(const SSTD_t *trans) { return trans->initiator2target_buffer_size <= SERIAL_DUPLEX_MAX_PAYLOAD && trans->target2initiator_buffer_size <= SERIAL_DUPLEX_MAX_PAYLOAD; }
+
+static uint8_t frame_id(uint8_t index, uint8_t sequence, bool from_target) { return index | sequence << SERIAL_DUPLEX_SEQUENCE_SHIFT | (from_target ? SERIAL_DUPLEX_FROM_TARGET : 0); }
+
+static void push_target_buffer(serial_duplex_t *link, uint8_t index, uint8_t sequence) {
+    SSTD_t *trans = &link->table[index];
+    if (!transaction_fits(trans)) {
+        return;
+    }
+
+    uint8_t checksum = send_frame(link, frame_id(index, sequence, true), trans->target2initiator_buffer, trans->target2initiator_buffer_size);
+
+    // serial_duplex_stream() compares against pushes, which have no sequence
+    link->sent_checksum[index] = sequence ? frame_checksum(frame_id(index, 0, true), trans->target2initiator_buffer, trans->target2initiator_buffer_size) : checksum;
+    link->pushed |= 1 << index;
+}
+
+static void deliver_frame(serial_duplex_t *link) {
+    SSTD_t *trans = &link->table[link->rx_id];
+
+    link->stats.frames_received++;
+    if (link->initiator) {
+        memcpy(trans->target2initiator_buffer, link->rx_buffer, link->rx_length);
+        link->last_reply[link->rx_id] = timer_read();
+        link->replied |= 1 << link->rx_id;
+        if (link->rx_sequence) {
+            link->answered_sequence[link->rx_id] = link->rx_sequence;
+        }
+    } else {
+        memcpy(trans->initiator2target_buffer, link->rx_buffer, link->rx_length);
+        if (trans->status) {
+            *trans->status = TRANSACTION_ACCEPTED;
+        }
+        // Every request is answered, which also acknowledges write-only transactions
+        push_target_buffer(link, link->rx_id, link->rx_sequence);
+    }
+}
+
+// Drop the frame in progress, the byte that broke it may start the next one
+static void resync(serial_duplex_t *link, uint8_t data) {
+    link->stats.framing_errors++;
+    link->rx_state = data == SERIAL_DUPLEX_SOF ? SERIAL_DUPLEX_ID : SERIAL_DUPLEX_HUNT;
+}
+
+void serial_duplex_receive(serial_duplex_t *link, const uint8_t *data, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+
+        switch (link->rx_state) {
+            case SERIAL_DUPLEX_HUNT:
+                if (byte == SERIAL_DUPLEX_SOF) {
+                    link->rx_state = SERIAL_DUPLEX_ID;
+                }
+                break;
+
+            case SERIAL_DUPLEX_ID: {
+                uint8_t index       = byte & SERIAL_DUPLEX_INDEX_MASK;
+                bool    from_target = byte & SERIAL_DUPLEX_FROM_TARGET;
+                if (index >= link->table_size || from_target != link->initiator) {
+                    resync(link, byte);
+                    break;
+                }
+                link->rx_id       = index;
+                link->rx_sequence = (byte & SERIAL_DUPLEX_SEQUENCE_MASK) >> SERIAL_DUPLEX_SEQUENCE_SHIFT;
+                link->rx_state    = SERIAL_DUPLEX_LENGTH;
+                break;
+            }
+
+            case SERIAL_DUPLEX_LENGTH: {
+                SSTD_t *trans    = &link->table[link->rx_id];
+                uint8_t expected = link->initiator ? trans->target2initiator_buffer_size : trans->initiator2target_buffer_size;
+                if (byte != expected || byte > SERIAL_DUPLEX_MAX_PAYLOAD) {
+                    resync(link, byte);
+                    break;
+                }
+                link->rx_length = byte;
+                link->rx_count  = 0;
+                link->rx_state  = byte ? SERIAL_DUPLEX_PAYLOAD : SERIAL_DUPLEX_CHECKSUM;
+                break;
+            }
+
+            case SERIAL_DUPLEX_PAYLOAD:
+                link->rx_buffer[link->rx_count++] = byte;
+                if (link->rx_count == link->rx_length) {
+                    link->rx_state = SERIAL_DUPLEX_CHECKSUM;
+                }
+                break;
+
+            case SERIAL_DUPLEX_CHECKSUM: {
+                uint8_t id = frame_id(link->rx_id, link->rx_sequence, link->initiator);
+                // A corrupted frame may have swallowed the start of the next
+                // one, there is no way back so just hunt for the one after
+                link->rx_state = SERIAL_DUPLEX_HUNT;
+                if (byte != frame_checksum(id, link->rx_buffer, link->rx_length)) {
+                    link->stats.checksum_errors++;
+                    break;
+                }
+                deliver_frame(link);
+                break;
+            }
+        }
+    }
+}
+
+void serial_duplex_init(serial_duplex_t *link, SSTD_t *table, uint8_t table_size, bool initiator) {
+    memset(link, 0, sizeof(*link));
+    link->table      = table;
+    link->table_size = table_size < SERIAL_DUPLEX_MAX_TRANSACTIONS ? table_size : SERIAL_DUPLEX_MAX_TRANSACTIONS;
+    link->initiator  = initiator;
+    link->rx_state   = SERIAL_DUPLEX_HUNT;
+}
+
+bool serial_duplex_connected(serial_duplex_t *link, uint8_t index) {
+    uint8_t bit = 1 << index;
+    if (!(link->replied & bit)) {
+        return false;
+    }
+    if (timer_elapsed(link->last_reply[index]) >= SERIAL_DUPLEX_TIMEOUT) {
+        // Forget the reply, so that the timer wrapping can't bring it back
+        link->replied &= ~bit;
+        return false;
+    }
+    return true;
+}
+
+/* Sends the request and waits for the answer carrying its sequence. Frames
+ * the target pushed before it saw the request may still be queued, and
+ * finishing on those would hand transport.c data older than an answer it
+ * already has to another transaction. Gives NO_RESPONSE if no answer comes
+ * within SERIAL_DUPLEX_TIMEOUT.
+ */
+int serial_duplex_transaction(serial_duplex_t *link, uint8_t index) {
+    if (index >= link->table_size || !transaction_fits(&link->table[index])) {
+        return TRANSACTION_TYPE_ERROR;
+    }
+    SSTD_t *trans = &link->table[index];
+
+    serial_duplex_backend_poll(link, 0);
+    uint8_t sequence              = link->request_sequence[index] % 15 + 1;
+    link->request_sequence[index] = sequence;
+    send_frame(link, frame_id(index, sequence, false), trans->initiator2target_buffer, trans->initiator2target_buffer_size);
+
+    uint16_t start = timer_read();
+    while (link->answered_sequence[index] != sequence && timer_elapsed(start) < SERIAL_DUPLEX_TIMEOUT) {
+        serial_duplex_backend_poll(link, 1);
+    }
+
+    int status = link->answered_sequence[index] == sequence ? TRANSACTION_END : TRANSACTION_NO_RESPONSE;
+    if (trans->status) {
+        *trans->status = status;
+    }
+    return status;
+}
+
+void serial_duplex_stream(serial_duplex_t *link) {
+    for (uint8_t i = 0; i < link->table_size; i++) {
+        SSTD_t *trans = &link->table[i];
+        if (!trans->target2initiator_buffer_size) {
+            continue;
+        }
+        if (!(link->pushed & (1 << i)) || frame_checksum(i | SERIAL_DUPLEX_FROM_TARGET, trans->target2initiator_buffer, trans->target2initiator_buffer_size) != link->sent_checksum[i]) {
+            push_target_buffer(link, i, 0);
+        }
+    }
+}
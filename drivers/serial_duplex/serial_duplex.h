@@ -0,0 +1,120 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Full-duplex framed split link.
+ *
+ * Each side owns a TX line, so the halves never take turns: the master sends
+ * a request frame per transaction, the slave answers every request and
+ * additionally pushes its target2initiator buffers as soon as they change.
+ * A master transaction completes once the answer to its own request is in,
+ * so its data is never older than the request, even when frames pushed
+ * earlier are still queued.
+ *
+ * Frame layout:
+ *   SOF | id (| sequence << 3) (| SERIAL_DUPLEX_FROM_TARGET) | length | payload... | crc8
+ *
+ * Requests carry a sequence number from 1 to 15 that the answer echoes,
+ * pushed frames carry 0.
+ *
+ * The length of every frame is known from the transaction table, so anything
+ * that does not match, or fails its checksum, is dropped and the receiver
+ * hunts for the next start of frame.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial.h"
+
+#ifndef SERIAL_DUPLEX_TIMEOUT
+#    define SERIAL_DUPLEX_TIMEOUT 100  // ms without a reply before a transaction reports NO_RESPONSE
+#endif
+
+#ifndef SERIAL_DUPLEX_MAX_TRANSACTIONS
+#    define SERIAL_DUPLEX_MAX_TRANSACTIONS 8
+#endif
+#if SERIAL_DUPLEX_MAX_TRANSACTIONS > 8
+#    error SERIAL_DUPLEX_MAX_TRANSACTIONS must be 8 or less
+#endif
+
+#ifndef SERIAL_DUPLEX_MAX_PAYLOAD
+#    define SERIAL_DUPLEX_MAX_PAYLOAD 64
+#endif
+
+#define SERIAL_DUPLEX_SOF 0x7E
+#define SERIAL_DUPLEX_FROM_TARGET 0x80
+#define SERIAL_DUPLEX_INDEX_MASK 0x07
+#define SERIAL_DUPLEX_SEQUENCE_SHIFT 3
+#define SERIAL_DUPLEX_SEQUENCE_MASK 0x78
+#define SERIAL_DUPLEX_OVERHEAD 4  // SOF, id, length and checksum
+
+typedef enum {
+    SERIAL_DUPLEX_HUNT,
+    SERIAL_DUPLEX_ID,
+    SERIAL_DUPLEX_LENGTH,
+    SERIAL_DUPLEX_PAYLOAD,
+    SERIAL_DUPLEX_CHECKSUM,
+} serial_duplex_rx_state_t;
+
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t frames_received;
+    uint32_t checksum_errors;
+    uint32_t framing_errors;  // frames whose id or length did not match the table
+} serial_duplex_stats_t;
+
+typedef struct {
+    SSTD_t *table;
+    uint8_t table_size;
+    bool    initiator;
+
+    uint8_t rx_state;
+    uint8_t rx_id;
+    uint8_t rx_sequence;
+    uint8_t rx_length;
+    uint8_t rx_count;
+    uint8_t rx_buffer[SERIAL_DUPLEX_MAX_PAYLOAD];
+
+    // Initiator: when each transaction was last answered, and which ever were
+    uint16_t last_reply[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+    uint8_t  replied;
+
+    // Initiator: sequence of the last request sent and the last one answered
+    uint8_t request_sequence[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+    uint8_t answered_sequence[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+
+    // Target: checksum of the last buffer pushed for each transaction. A
+    // collision only delays a change until the next request is answered.
+    uint8_t sent_checksum[SERIAL_DUPLEX_MAX_TRANSACTIONS];
+    uint8_t pushed;
+
+    serial_duplex_stats_t stats;
+} serial_duplex_t;
+
+void serial_duplex_init(serial_duplex_t *link, SSTD_t *table, uint8_t table_size, bool initiator);
+void serial_duplex_receive(serial_duplex_t *link, const uint8_t *data, uint8_t length);
+int  serial_duplex_transaction(serial_duplex_t *link, uint8_t index);
+void serial_duplex_stream(serial_duplex_t *link);
+bool serial_duplex_connected(serial_duplex_t *link, uint8_t index);
+
+/* Backend interface.
+ *
+ * send() hands over a complete frame, which may be transmitted after it
+ * returns, so it must be copied. poll() feeds whatever has been received
+ * to serial_duplex_receive(), waiting up to timeout ms for the first byte.
+ */
+void serial_duplex_backend_send(serial_duplex_t *link, const uint8_t *frame, uint8_t length);
+void serial_duplex_backend_poll(serial_duplex_t *link, uint16_t timeout);
@@ -0,0 +1,10 @@
+serial_duplex_INC := \
+	$(DRIVER_PATH)/serial_duplex/tests \
+	$(DRIVER_PATH)/serial_duplex \
+	$(DRIVER_PATH)/chibios
+
+serial_duplex_SRC := \
+	$(DRIVER_PATH)/serial_duplex/tests/serial_duplex_stub.c \
+	$(DRIVER_PATH)/serial_duplex/tests/serial_duplex_tests.cpp \
+	$(DRIVER_PATH)/serial_duplex/serial_duplex.c \
+	$(TMK_PATH)/common/test/timer.c
@@ -0,0 +1,114 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Loopback backend for the full-duplex link.
+ *
+ * Both ends of the link live in the same process and each direction is a
+ * byte pipe. Nothing runs in the background: the slave only runs while the
+ * master waits for an answer, and tests call serial_duplex_stub_run_slave()
+ * to stand in for the slave's transport thread getting scheduled otherwise.
+ */
+#include "serial_duplex_stub.h"
+#include <string.h>
+
+void advance_time(uint32_t ms);
+
+serial_duplex_t serial_duplex_stub_master;
+serial_duplex_t serial_duplex_stub_slave;
+
+typedef struct {
+    uint8_t  data[SERIAL_DUPLEX_STUB_PIPE_SIZE];
+    uint16_t length;
+} stub_pipe_t;
+
+static stub_pipe_t to_master;
+static stub_pipe_t to_slave;
+static bool        stub_connected;
+static int32_t     stub_corrupt_at;  // offset into the next sent bytes, or -1
+
+static stub_pipe_t *pipe_to(serial_duplex_t *link) { return link == &serial_duplex_stub_master ? &to_master : &to_slave; }
+
+static void pipe_write(stub_pipe_t *pipe, const uint8_t *data, uint16_t length) {
+    if (pipe->length + length > SERIAL_DUPLEX_STUB_PIPE_SIZE) {
+        length = SERIAL_DUPLEX_STUB_PIPE_SIZE - pipe->length;  // overrun, like a full RX queue
+    }
+    memcpy(&pipe->data[pipe->length], data, length);
+    pipe->length += length;
+}
+
+void serial_duplex_stub_reset(void) {
+    memset(&to_master, 0, sizeof(to_master));
+    memset(&to_slave, 0, sizeof(to_slave));
+    stub_connected  = true;
+    stub_corrupt_at = -1;
+}
+
+void serial_duplex_stub_connect(bool connected) { stub_connected = connected; }
+
+void serial_duplex_stub_corrupt_next(uint16_t offset) { stub_corrupt_at = offset; }
+
+void serial_duplex_stub_inject(serial_duplex_t *to, const uint8_t *data, uint16_t length) { pipe_write(pipe_to(to), data, length); }
+
+uint16_t serial_duplex_stub_pending(serial_duplex_t *to) { return pipe_to(to)->length; }
+
+void serial_duplex_stub_run_slave(void) {
+    serial_duplex_backend_poll(&serial_duplex_stub_slave, 0);
+    serial_duplex_stream(&serial_duplex_stub_slave);
+}
+
+void serial_duplex_backend_send(serial_duplex_t *link, const uint8_t *frame, uint8_t length) {
+    if (!stub_connected) {
+        return;
+    }
+
+    uint8_t copy[SERIAL_DUPLEX_MAX_PAYLOAD + SERIAL_DUPLEX_OVERHEAD];
+    memcpy(copy, frame, length);
+    if (stub_corrupt_at >= 0) {
+        if (stub_corrupt_at < length) {
+            copy[stub_corrupt_at] ^= 0x01;
+            stub_corrupt_at = -1;
+        } else {
+            stub_corrupt_at -= length;
+        }
+    }
+
+    pipe_write(pipe_to(link == &serial_duplex_stub_master ? &serial_duplex_stub_slave : &serial_duplex_stub_master), copy, length);
+}
+
+void serial_duplex_backend_poll(serial_duplex_t *link, uint16_t timeout) {
+    stub_pipe_t *pipe = pipe_to(link);
+
+    // The slave thread gets to run while the master blocks, and the wait
+    // only takes time if nothing turns up
+    if (timeout && link == &serial_duplex_stub_master) {
+        serial_duplex_stub_run_slave();
+        if (!pipe->length) {
+            advance_time(timeout);
+        }
+    }
+
+    // Frames sent while receiving (the slave's answers) go to the other pipe,
+    // so the whole pipe can be handed over in one go
+    uint8_t  data[SERIAL_DUPLEX_STUB_PIPE_SIZE];
+    uint16_t length = pipe->length;
+    memcpy(data, pipe->data, length);
+    pipe->length = 0;
+
+    for (uint16_t offset = 0; offset < length; offset += UINT8_MAX) {
+        uint16_t chunk = length - offset;
+        serial_duplex_receive(link, &data[offset], chunk > UINT8_MAX ? UINT8_MAX : chunk);
+    }
+}
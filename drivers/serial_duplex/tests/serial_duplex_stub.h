@@ -0,0 +1,33 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "serial_duplex.h"
+
+#define SERIAL_DUPLEX_STUB_PIPE_SIZE 512
+
+extern serial_duplex_t serial_duplex_stub_master;
+extern serial_duplex_t serial_duplex_stub_slave;
+
+void     serial_duplex_stub_reset(void);
+void     serial_duplex_stub_connect(bool connected);
+void     serial_duplex_stub_corrupt_next(uint16_t offset);
+void     serial_duplex_stub_inject(serial_duplex_t *to, const uint8_t *data, uint16_t length);
+uint16_t serial_duplex_stub_pending(serial_duplex_t *to);
+void     serial_duplex_stub_run_slave(void);
@@ -0,0 +1,176 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "serial_duplex.h"
+#include "serial_duplex_stub.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+enum { GET_SLAVE_MATRIX, PUT_RGBLIGHT, TRANSACTION_COUNT };
+
+struct side_t {
+    uint8_t matrix[4];
+    uint8_t backlight;
+    uint8_t rgblight[3];
+    uint8_t status[TRANSACTION_COUNT];
+    SSTD_t  table[TRANSACTION_COUNT];
+
+    void init(serial_duplex_t *link, bool initiator) {
+        memset(this, 0, sizeof(*this));
+        table[GET_SLAVE_MATRIX] = {&status[GET_SLAVE_MATRIX], sizeof(backlight), &backlight, sizeof(matrix), matrix};
+        table[PUT_RGBLIGHT]     = {&status[PUT_RGBLIGHT], sizeof(rgblight), rgblight, 0, NULL};
+        serial_duplex_init(link, table, TRANSACTION_COUNT, initiator);
+    }
+};
+
+class SerialDuplexTest : public ::testing::Test {
+   protected:
+    side_t master;
+    side_t slave;
+
+    serial_duplex_t *master_link = &serial_duplex_stub_master;
+    serial_duplex_t *slave_link  = &serial_duplex_stub_slave;
+
+    void SetUp() override {
+        set_time(1000);
+        serial_duplex_stub_reset();
+        master.init(master_link, true);
+        slave.init(slave_link, false);
+    }
+
+    // One master scan with the slave thread getting scheduled after it
+    int scan(uint8_t index = GET_SLAVE_MATRIX) {
+        int status = serial_duplex_transaction(master_link, index);
+        serial_duplex_stub_run_slave();
+        advance_time(1);
+        return status;
+    }
+};
+
+TEST_F(SerialDuplexTest, TestTransactionWaitsForItsAnswer) {
+    slave.matrix[0] = 0x11;
+    EXPECT_EQ(scan(), TRANSACTION_END);
+    EXPECT_EQ(master.status[GET_SLAVE_MATRIX], TRANSACTION_END);
+    EXPECT_EQ(master.matrix[0], 0x11);
+    EXPECT_TRUE(serial_duplex_connected(master_link, GET_SLAVE_MATRIX));
+    EXPECT_FALSE(serial_duplex_connected(master_link, PUT_RGBLIGHT));
+}
+
+TEST_F(SerialDuplexTest, TestQueuedPushDoesNotCompleteTransaction) {
+    scan();
+    slave.matrix[0] = 0x01;
+    serial_duplex_stub_run_slave();
+
+    // The push of 0x01 is still queued when the slave changes again and the
+    // next request goes out, which must end with the answer
+    slave.matrix[0] = 0x02;
+    EXPECT_EQ(serial_duplex_transaction(master_link, GET_SLAVE_MATRIX), TRANSACTION_END);
+    EXPECT_EQ(master.matrix[0], 0x02);
+}
+
+TEST_F(SerialDuplexTest, TestMasterDataReachesSlave) {
+    master.backlight   = 3;
+    master.rgblight[1] = 0x42;
+    scan(GET_SLAVE_MATRIX);
+    scan(PUT_RGBLIGHT);
+
+    EXPECT_EQ(slave.backlight, 3);
+    EXPECT_EQ(slave.rgblight[1], 0x42);
+    EXPECT_EQ(slave.status[PUT_RGBLIGHT], TRANSACTION_ACCEPTED);
+
+    // Write-only transactions are acknowledged with an empty frame
+    EXPECT_EQ(scan(PUT_RGBLIGHT), TRANSACTION_END);
+}
+
+TEST_F(SerialDuplexTest, TestSlaveStreamsChanges) {
+    scan();
+    scan();
+    serial_duplex_backend_poll(master_link, 0);
+    uint32_t sent = slave_link->stats.frames_sent;
+
+    // Nothing changed, nothing is pushed
+    serial_duplex_stub_run_slave();
+    EXPECT_EQ(slave_link->stats.frames_sent, sent);
+    EXPECT_EQ(serial_duplex_stub_pending(master_link), 0);
+
+    // A change goes out without waiting for the next request
+    slave.matrix[2] = 0x80;
+    serial_duplex_stub_run_slave();
+    EXPECT_EQ(slave_link->stats.frames_sent, sent + 1);
+    serial_duplex_backend_poll(master_link, 0);
+    EXPECT_EQ(master.matrix[2], 0x80);
+}
+
+TEST_F(SerialDuplexTest, TestCorruptFrameIsDropped) {
+    scan();
+    scan();
+    slave.matrix[1] = 0x05;
+
+    // Flip a payload bit of the slave's next frame
+    serial_duplex_stub_corrupt_next(4);
+    serial_duplex_stub_run_slave();
+    serial_duplex_backend_poll(master_link, 0);
+    EXPECT_EQ(master_link->stats.checksum_errors, 1);
+    EXPECT_EQ(master.matrix[1], 0);
+
+    // The answer to the next request gets through
+    scan();
+    serial_duplex_backend_poll(master_link, 0);
+    EXPECT_EQ(master.matrix[1], 0x05);
+}
+
+TEST_F(SerialDuplexTest, TestResyncAfterNoise) {
+    scan();
+    scan();
+
+    // Line noise, including a stray start of frame and a truncated frame
+    uint8_t noise[] = {0x00, 0xFF, SERIAL_DUPLEX_SOF, 0x55, SERIAL_DUPLEX_SOF, GET_SLAVE_MATRIX | SERIAL_DUPLEX_FROM_TARGET, 0x09};
+    serial_duplex_stub_inject(master_link, noise, sizeof(noise));
+
+    slave.matrix[3] = 0x33;
+    serial_duplex_stub_run_slave();
+    serial_duplex_backend_poll(master_link, 0);
+    EXPECT_EQ(master.matrix[3], 0x33);
+    EXPECT_EQ(master_link->stats.framing_errors, 2);
+    EXPECT_EQ(master_link->stats.checksum_errors, 0);
+}
+
+TEST_F(SerialDuplexTest, TestDisconnectAndReconnect) {
+    scan();
+    EXPECT_EQ(scan(), TRANSACTION_END);
+
+    serial_duplex_stub_connect(false);
+    uint32_t start = timer_read32();
+    EXPECT_EQ(scan(), TRANSACTION_NO_RESPONSE);
+    EXPECT_GE(timer_elapsed32(start), SERIAL_DUPLEX_TIMEOUT);
+    EXPECT_FALSE(serial_duplex_connected(master_link, GET_SLAVE_MATRIX));
+
+    serial_duplex_stub_connect(true);
+    slave.matrix[0] = 0x01;
+    EXPECT_EQ(scan(), TRANSACTION_END);
+    EXPECT_EQ(master.matrix[0], 0x01);
+}
+
+TEST_F(SerialDuplexTest, TestUnknownTransaction) {
+    EXPECT_EQ(serial_duplex_transaction(master_link, TRANSACTION_COUNT), TRANSACTION_TYPE_ERROR);
+    EXPECT_EQ(master_link->stats.frames_sent, 0);
+}
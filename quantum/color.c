@@ -106,6 +106,56 @@ RGB hsv_to_rgb(HSV hsv) {
 
 RGB hsv_to_rgb_nocie(HSV hsv) { return hsv_to_rgb_impl(hsv, false); }
 
+// Two 16 bit products per 32 bit multiply, only worth it where that multiply is cheap
+#if !defined(__AVR__) && !defined(HSV_TO_RGB_NO_PACKED)
+#    define HSV_TO_RGB_PACKED
+#endif
+
+enum { HSV_CHANNEL_V, HSV_CHANNEL_P, HSV_CHANNEL_Q, HSV_CHANNEL_T };
+
+#define HSV_REGION(r, g, b) (HSV_CHANNEL_##r | HSV_CHANNEL_##g << 2 | HSV_CHANNEL_##b << 4)
+
+// Which of v, p, q and t goes to red, green and blue in each region of hsv_to_rgb_impl.
+// h = 255 lands in region 6, which wraps around to region 0. Zero saturation uses the last entry.
+static const uint8_t hsv_region_channels[8] PROGMEM = {HSV_REGION(V, T, P), HSV_REGION(Q, V, P), HSV_REGION(P, V, T), HSV_REGION(P, Q, V), HSV_REGION(T, P, V), HSV_REGION(V, P, Q), HSV_REGION(V, T, P), HSV_REGION(V, V, V)};
+
+// Same results as hsv_to_rgb, without the division and the switch
+void hsv_to_rgb_n(const HSV *hsv, RGB *rgb, uint8_t n) {
+    for (; n; n--, hsv++, rgb++) {
+        uint8_t channels[4];
+        uint8_t s = hsv->s;
+#ifdef USE_CIE1931_CURVE
+        uint8_t v = pgm_read_byte(&CIE1931_CURVE[hsv->v]);
+#else
+        uint8_t v = hsv->v;
+#endif
+
+        // h * 6 / 255 for every h
+        uint16_t x         = hsv->h * 6;
+        uint8_t  region    = (x + 1 + (x >> 8)) >> 8;
+        uint8_t  remainder = (hsv->h * 2 - region * 85) * 3;
+
+        channels[HSV_CHANNEL_V] = v;
+        channels[HSV_CHANNEL_P] = (v * (255 - s)) >> 8;
+#ifdef HSV_TO_RGB_PACKED
+        // s * remainder in the low half and s * (255 - remainder) in the high half, then the same for v
+        uint32_t scaled = (uint32_t)s * (remainder | (uint32_t)(255 - remainder) << 16);
+        uint32_t faded  = (uint32_t)v * (0x00FF00FF - ((scaled >> 8) & 0x00FF00FF));
+
+        channels[HSV_CHANNEL_Q] = faded >> 8;
+        channels[HSV_CHANNEL_T] = faded >> 24;
+#else
+        channels[HSV_CHANNEL_Q] = (v * (255 - ((s * remainder) >> 8))) >> 8;
+        channels[HSV_CHANNEL_T] = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+#endif
+
+        uint8_t map = pgm_read_byte(&hsv_region_channels[s ? region : 7]);
+        rgb->r      = channels[map & 3];
+        rgb->g      = channels[(map >> 2) & 3];
+        rgb->b      = channels[map >> 4];
+    }
+}
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -91,6 +91,7 @@ typedef struct PACKED {
 
 RGB hsv_to_rgb(HSV hsv);
 RGB hsv_to_rgb_nocie(HSV hsv);
+void hsv_to_rgb_n(const HSV *hsv, RGB *rgb, uint8_t n);
 #ifdef RGBW
 void convert_rgb_to_rgbw(LED_TYPE *led);
 #endif
@@ -0,0 +1,148 @@
+/*
+Copyright 2021 QMK
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Per-key eager algorithm with vertical counters, behaving like sym_eager_pk.
+After a key changes state it is locked for DEBOUNCE milliseconds, counted
+down per key. Instead of a byte per key, bit n of every counter in a row is
+kept in counters[row][n], so a whole row is counted down, tested and
+reloaded with a few word operations. Rows with no locked key are skipped.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+// Bits needed to count down from DEBOUNCE
+#if DEBOUNCE < 2
+#    define COUNTER_BITS 1
+#elif DEBOUNCE < 4
+#    define COUNTER_BITS 2
+#elif DEBOUNCE < 8
+#    define COUNTER_BITS 3
+#elif DEBOUNCE < 16
+#    define COUNTER_BITS 4
+#elif DEBOUNCE < 32
+#    define COUNTER_BITS 5
+#elif DEBOUNCE < 64
+#    define COUNTER_BITS 6
+#elif DEBOUNCE < 128
+#    define COUNTER_BITS 7
+#elif DEBOUNCE < 256
+#    define COUNTER_BITS 8
+#else
+#    error DEBOUNCE must be 255 or less for sym_eager_pk_vc
+#endif
+
+static matrix_row_t counters[MATRIX_ROWS][COUNTER_BITS];
+static matrix_row_t locked[MATRIX_ROWS];  // keys whose counter is not zero
+static uint16_t     last_time;
+static bool         counters_need_update;
+static bool         matrix_need_update;
+
+static void update_debounce_counters(uint8_t num_rows, uint16_t elapsed);
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+            counters[row][bit] = 0;
+        }
+        locked[row] = 0;
+    }
+    counters_need_update = false;
+    matrix_need_update   = false;
+    last_time            = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+
+    if (counters_need_update && elapsed) {
+        update_debounce_counters(num_rows, elapsed);
+    }
+
+    if (changed || matrix_need_update) {
+        transfer_matrix_values(raw, cooked, num_rows);
+    }
+}
+
+// Count the locked keys down by elapsed ms, unlocking those that reach zero
+static void update_debounce_counters(uint8_t num_rows, uint16_t elapsed) {
+    counters_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        if (!locked[row]) {
+            continue;
+        }
+
+        matrix_row_t *counter = counters[row];
+        if (elapsed >= DEBOUNCE) {
+            for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+                counter[bit] = 0;
+            }
+            locked[row] = 0;
+            continue;
+        }
+
+        for (uint16_t step = 0; step < elapsed; step++) {
+            // Subtract one from every locked counter: a bit flips while the
+            // borrow reaches it, and the borrow carries on past zero bits
+            matrix_row_t borrow       = locked[row];
+            matrix_row_t still_locked = 0;
+            for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+                matrix_row_t value = counter[bit];
+                counter[bit]       = value ^ borrow;
+                borrow &= ~value;
+                still_locked |= counter[bit];
+            }
+            locked[row] = still_locked;
+        }
+        counters_need_update |= locked[row] != 0;
+    }
+}
+
+// upload from raw_matrix to final matrix;
+static void transfer_matrix_values(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    matrix_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t delta = raw[row] ^ cooked[row];
+        if (!delta) {
+            continue;
+        }
+
+        // Changes to locked keys wait until they unlock
+        matrix_need_update |= (delta & locked[row]) != 0;
+        delta &= ~locked[row];
+        cooked[row] ^= delta;
+
+        // Load DEBOUNCE into the counters of the keys that just changed
+        matrix_row_t *counter = counters[row];
+        for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+            counter[bit] = (counter[bit] & ~delta) | ((DEBOUNCE >> bit) & 1 ? delta : 0);
+        }
+        if (DEBOUNCE) {
+            locked[row] |= delta;
+            counters_need_update |= delta != 0;
+        }
+    }
+}
+
+bool debounce_active(void) { return true; }
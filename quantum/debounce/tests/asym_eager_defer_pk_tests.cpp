@@ -0,0 +1,145 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix.h"
+#include "debounce.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+class DebounceAsymEagerDeferTest : public ::testing::Test {
+   protected:
+    matrix_row_t raw[MATRIX_ROWS]      = {};
+    matrix_row_t cooked[MATRIX_ROWS]   = {};
+    matrix_row_t last_raw[MATRIX_ROWS] = {};
+
+    void SetUp() override {
+        set_time(1000);
+        debounce_init(MATRIX_ROWS);
+    }
+
+    void set_key(uint8_t row, uint8_t col, bool pressed) {
+        if (pressed) {
+            raw[row] |= MATRIX_ROW_SHIFTER << col;
+        } else {
+            raw[row] &= ~(MATRIX_ROW_SHIFTER << col);
+        }
+    }
+
+    bool is_pressed(uint8_t row, uint8_t col) { return cooked[row] & (MATRIX_ROW_SHIFTER << col); }
+
+    // One scan per ms, as a keyboard would. A release is timed from the first scan that sees it.
+    void scan(uint32_t ms = 1) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            bool changed = memcmp(raw, last_raw, sizeof(raw)) != 0;
+            memcpy(last_raw, raw, sizeof(raw));
+            debounce(raw, cooked, MATRIX_ROWS, changed);
+        }
+    }
+};
+
+TEST_F(DebounceAsymEagerDeferTest, PressIsReportedImmediately) {
+    set_key(0, 0, true);
+    scan();
+    EXPECT_TRUE(is_pressed(0, 0));
+}
+
+TEST_F(DebounceAsymEagerDeferTest, ReleaseIsDeferred) {
+    set_key(0, 0, true);
+    scan(20);
+    set_key(0, 0, false);
+    scan(DEBOUNCE);
+    EXPECT_TRUE(is_pressed(0, 0));
+    scan();
+    EXPECT_FALSE(is_pressed(0, 0));
+}
+
+TEST_F(DebounceAsymEagerDeferTest, ChatterAfterPressIsIgnored) {
+    set_key(1, 1, true);
+    scan();
+    for (int i = 0; i < 10; i++) {
+        set_key(1, 1, i % 2);
+        scan();
+        EXPECT_TRUE(is_pressed(1, 1)) << "after " << i + 1 << "ms";
+    }
+}
+
+TEST_F(DebounceAsymEagerDeferTest, ReleaseChatterRestartsTheWait) {
+    set_key(2, 3, true);
+    scan(20);
+
+    set_key(2, 3, false);
+    scan(DEBOUNCE - 1);
+    set_key(2, 3, true);
+    scan();
+    set_key(2, 3, false);
+    scan(DEBOUNCE);
+    EXPECT_TRUE(is_pressed(2, 3));
+
+    scan();
+    EXPECT_FALSE(is_pressed(2, 3));
+}
+
+TEST_F(DebounceAsymEagerDeferTest, PressAfterReleaseIsImmediate) {
+    set_key(3, 9, true);
+    scan(20);
+    set_key(3, 9, false);
+    scan(DEBOUNCE + 1);
+    EXPECT_FALSE(is_pressed(3, 9));
+
+    set_key(3, 9, true);
+    scan();
+    EXPECT_TRUE(is_pressed(3, 9));
+}
+
+TEST_F(DebounceAsymEagerDeferTest, KeysAreDebouncedIndependently) {
+    set_key(0, 2, true);
+    set_key(0, 5, true);
+    scan(20);
+
+    set_key(0, 2, false);
+    scan(2);
+    set_key(0, 5, false);
+    scan(DEBOUNCE - 1);
+    EXPECT_FALSE(is_pressed(0, 2));
+    EXPECT_TRUE(is_pressed(0, 5));
+
+    set_key(0, 7, true);
+    scan();
+    EXPECT_TRUE(is_pressed(0, 5));
+    EXPECT_TRUE(is_pressed(0, 7));
+
+    scan();
+    EXPECT_FALSE(is_pressed(0, 5));
+    EXPECT_TRUE(is_pressed(0, 7));
+}
+
+TEST_F(DebounceAsymEagerDeferTest, ReleaseAcrossTimerWrap) {
+    set_time(0xFFFF - 2);
+    set_key(1, 4, true);
+    scan();
+    set_key(1, 4, false);
+    scan(DEBOUNCE);
+    EXPECT_TRUE(is_pressed(1, 4));
+    scan();
+    EXPECT_FALSE(is_pressed(1, 4));
+}
@@ -0,0 +1,77 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Replays bounce traces through whichever algorithm this test is built with.
+ * Every algorithm must handle chatter shorter than DEBOUNCE; beyond that, with
+ * QMK_BENCHMARK set, it prints press and release latency (average/max ms),
+ * spurious and missed changes and the time spent per scan to compare.
+ *
+ * Set DEBOUNCE_TRACE to the path of a recorded trace to replay it as well.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdlib>
+#include "debounce_trace.h"
+#include "test_ticks.hpp"
+
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+#define ALGORITHM STRINGIFY(DEBOUNCE_ALGORITHM)
+
+#define EXAMPLE_TRACE "quantum/debounce/tests/traces/example.trace"
+
+static debounce_stats_t benchmark(const bounce_trace_t &trace, uint32_t scan_interval = 1) {
+    debounce_stats_t stats = replay_trace(trace, scan_interval);
+    if (benchmark_enabled()) print_stats(ALGORITHM, trace, stats);
+    EXPECT_GT(stats.keystrokes, 0u);
+    return stats;
+}
+
+TEST(DebounceBenchmark, CleanSwitches) {
+    debounce_stats_t stats = benchmark(synthetic_trace("clean", {1000, 0, 0, 1}));
+    EXPECT_EQ(stats.spurious, 0u);
+    EXPECT_EQ(stats.missed, 0u);
+}
+
+TEST(DebounceBenchmark, ChatterShorterThanDebounce) {
+    debounce_stats_t stats = benchmark(synthetic_trace("chatter", {1000, DEBOUNCE - 1, 0, 2}));
+    EXPECT_EQ(stats.spurious, 0u);
+    EXPECT_EQ(stats.missed, 0u);
+}
+
+TEST(DebounceBenchmark, ChatterLongerThanDebounce) {
+    debounce_stats_t stats = benchmark(synthetic_trace("long chatter", {1000, 3 * DEBOUNCE, 0, 3}));
+    EXPECT_EQ(stats.missed, 0u);
+}
+
+TEST(DebounceBenchmark, NoisyIdleKeys) {
+    debounce_stats_t stats = benchmark(synthetic_trace("noise", {1000, DEBOUNCE - 1, 20, 4}));
+    EXPECT_EQ(stats.missed, 0u);
+}
+
+TEST(DebounceBenchmark, SlowScans) {
+    debounce_stats_t stats = benchmark(synthetic_trace("chatter, 3ms scans", {1000, DEBOUNCE - 1, 0, 2}), 3);
+    EXPECT_EQ(stats.missed, 0u);
+}
+
+TEST(DebounceBenchmark, RecordedTrace) {
+    const char *   path = getenv("DEBOUNCE_TRACE");
+    bounce_trace_t trace;
+    ASSERT_TRUE(load_trace(path ? path : EXAMPLE_TRACE, trace)) << "can't read " << (path ? path : EXAMPLE_TRACE);
+
+    debounce_stats_t stats = benchmark(trace);
+    EXPECT_EQ(stats.missed, 0u);
+}
@@ -0,0 +1,252 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "test_ticks.hpp"
+
+extern "C" {
+#include "matrix.h"
+#include "debounce.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+}
+
+#define NUM_KEYS (MATRIX_ROWS * MATRIX_COLS)
+#define TRACE_START_TIME 1000
+
+typedef struct {
+    uint32_t time;
+    bool     pressed;
+} key_change_t;
+
+static inline uint16_t key_index(uint8_t row, uint8_t col) { return row * MATRIX_COLS + col; }
+
+static void sort_edges(bounce_trace_t &trace) {
+    std::stable_sort(trace.edges.begin(), trace.edges.end(), [](const trace_edge_t &a, const trace_edge_t &b) { return a.time < b.time; });
+    trace.length = trace.edges.empty() ? 0 : trace.edges.back().time + 100;
+}
+
+// A transition to level at time, chattering for up to bounce ms before it settles
+static void add_transition(std::vector<trace_edge_t> &edges, std::mt19937 &random, uint32_t time, uint8_t row, uint8_t col, bool level, uint32_t bounce) {
+    bool current = level;
+    edges.push_back({time, row, col, level});
+    for (uint32_t ms = 1; ms < bounce; ms++) {
+        if (random() % 2) {
+            current = !current;
+            edges.push_back({time + ms, row, col, current});
+        }
+    }
+    if (current != level) {
+        edges.push_back({time + bounce, row, col, level});
+    }
+}
+
+bounce_trace_t synthetic_trace(const char *name, const synthetic_trace_config_t &config) {
+    bounce_trace_t trace;
+    std::mt19937   random(config.seed);
+    uint32_t       busy_until[NUM_KEYS] = {};
+
+    trace.name   = name;
+    uint32_t now = 50;
+    for (uint32_t i = 0; i < config.keystrokes; i++) {
+        uint8_t row, col;
+        do {
+            row = random() % MATRIX_ROWS;
+            col = random() % MATRIX_COLS;
+        } while (busy_until[key_index(row, col)] > now);
+
+        // Keystrokes overlap, as they do when typing quickly
+        uint32_t hold    = TRACE_SETTLE_TIME + config.max_bounce + 10 + random() % 90;
+        uint32_t press   = config.max_bounce ? random() % (config.max_bounce + 1) : 0;
+        uint32_t release = config.max_bounce ? random() % (config.max_bounce + 1) : 0;
+        add_transition(trace.edges, random, now, row, col, true, press);
+        add_transition(trace.edges, random, now + hold, row, col, false, release);
+
+        busy_until[key_index(row, col)] = now + hold + release + TRACE_SETTLE_TIME + 1;
+        now += 20 + random() % 100;
+    }
+
+    // Glitches only go where the key is idle, so they can't merge with a real burst
+    uint32_t glitches = (uint64_t)now * config.noise / 1000;
+    for (uint32_t i = 0; i < glitches; i++) {
+        uint32_t time       = 50 + random() % now;
+        uint8_t  row        = random() % MATRIX_ROWS;
+        uint8_t  col        = random() % MATRIX_COLS;
+        bool     level      = false;
+        uint32_t level_time = 0;
+        bool     quiet      = true;
+        for (const trace_edge_t &edge : trace.edges) {
+            if (edge.row != row || edge.col != col) {
+                continue;
+            }
+            if (edge.time + TRACE_SETTLE_TIME >= time && edge.time <= time + 1 + TRACE_SETTLE_TIME) {
+                quiet = false;
+                break;
+            }
+            // The edges aren't sorted yet, glitches already added are out of order
+            if (edge.time < time && edge.time >= level_time) {
+                level      = edge.pressed;
+                level_time = edge.time;
+            }
+        }
+        if (quiet) {
+            trace.edges.push_back({time, row, col, !level});
+            trace.edges.push_back({time + 1, row, col, level});
+        }
+    }
+
+    sort_edges(trace);
+    return trace;
+}
+
+bool load_trace(const char *path, bounce_trace_t &trace) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    const char *name = strrchr(path, '/');
+    trace.name       = name ? name + 1 : path;
+    trace.edges.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        unsigned           time, row, col, level;
+        if (!(fields >> time >> row >> col >> level) || row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+            return false;
+        }
+        trace.edges.push_back({time, (uint8_t)row, (uint8_t)col, level != 0});
+    }
+    sort_edges(trace);
+    return true;
+}
+
+// The real presses and releases of each key, see debounce_trace.h
+static void expected_changes(const bounce_trace_t &trace, std::vector<key_change_t> expected[]) {
+    bool     level[NUM_KEYS]       = {};
+    bool     burst_from[NUM_KEYS]  = {};
+    uint32_t burst_start[NUM_KEYS] = {};
+    uint32_t last_edge[NUM_KEYS]   = {};
+    bool     in_burst[NUM_KEYS]    = {};
+
+    for (const trace_edge_t &edge : trace.edges) {
+        uint16_t key = key_index(edge.row, edge.col);
+        if (in_burst[key] && edge.time - last_edge[key] > TRACE_SETTLE_TIME) {
+            if (level[key] != burst_from[key]) {
+                expected[key].push_back({burst_start[key], level[key]});
+            }
+            in_burst[key] = false;
+        }
+        if (!in_burst[key]) {
+            in_burst[key]    = true;
+            burst_from[key]  = level[key];
+            burst_start[key] = edge.time;
+        }
+        level[key]     = edge.pressed;
+        last_edge[key] = edge.time;
+    }
+
+    for (uint16_t key = 0; key < NUM_KEYS; key++) {
+        if (in_burst[key] && level[key] != burst_from[key]) {
+            expected[key].push_back({burst_start[key], level[key]});
+        }
+    }
+}
+
+debounce_stats_t replay_trace(const bounce_trace_t &trace, uint32_t scan_interval) {
+    debounce_stats_t          stats = {};
+    std::vector<key_change_t> reported[NUM_KEYS];
+    std::vector<key_change_t> expected[NUM_KEYS];
+    matrix_row_t              raw[MATRIX_ROWS]         = {};
+    matrix_row_t              last_raw[MATRIX_ROWS]    = {};
+    matrix_row_t              cooked[MATRIX_ROWS]      = {};
+    matrix_row_t              last_cooked[MATRIX_ROWS] = {};
+
+    set_time(TRACE_START_TIME);
+    debounce_init(MATRIX_ROWS);
+
+    size_t next_edge = 0;
+    for (uint32_t now = 0; now <= trace.length; now += scan_interval) {
+        set_time(TRACE_START_TIME + now);
+        for (; next_edge < trace.edges.size() && trace.edges[next_edge].time <= now; next_edge++) {
+            const trace_edge_t &edge = trace.edges[next_edge];
+            if (edge.pressed) {
+                raw[edge.row] |= MATRIX_ROW_SHIFTER << edge.col;
+            } else {
+                raw[edge.row] &= ~(MATRIX_ROW_SHIFTER << edge.col);
+            }
+        }
+
+        bool changed = memcmp(raw, last_raw, sizeof(raw)) != 0;
+        memcpy(last_raw, raw, sizeof(raw));
+
+        uint64_t start = read_ticks();
+        debounce(raw, cooked, MATRIX_ROWS, changed);
+        stats.ticks += read_ticks() - start;
+        stats.scans++;
+
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t delta = cooked[row] ^ last_cooked[row];
+            for (uint8_t col = 0; delta && col < MATRIX_COLS; col++) {
+                if (delta & (MATRIX_ROW_SHIFTER << col)) {
+                    reported[key_index(row, col)].push_back({now, (bool)(cooked[row] & (MATRIX_ROW_SHIFTER << col))});
+                }
+            }
+            last_cooked[row] = cooked[row];
+        }
+    }
+
+    // Reported changes are matched to the real ones in order, anything in between is spurious
+    expected_changes(trace, expected);
+    for (uint16_t key = 0; key < NUM_KEYS; key++) {
+        size_t matched = 0;
+        for (const key_change_t &change : reported[key]) {
+            if (matched < expected[key].size() && change.pressed == expected[key][matched].pressed && change.time >= expected[key][matched].time) {
+                uint32_t latency = change.time - expected[key][matched].time;
+                if (change.pressed) {
+                    stats.presses++;
+                    stats.press_latency_total += latency;
+                    stats.press_latency_max = std::max(stats.press_latency_max, latency);
+                } else {
+                    stats.releases++;
+                    stats.release_latency_total += latency;
+                    stats.release_latency_max = std::max(stats.release_latency_max, latency);
+                }
+                matched++;
+            } else {
+                stats.spurious++;
+            }
+        }
+        stats.keystrokes += expected[key].size();
+        stats.missed += expected[key].size() - matched;
+    }
+    return stats;
+}
+
+void print_stats(const char *algorithm, const bounce_trace_t &trace, const debounce_stats_t &stats) {
+    printf("%-20s %-24s press %5.2f/%-3u release %5.2f/%-3u spurious %-4u missed %-4u %8.1f ticks/scan\n", algorithm, trace.name.c_str(), stats.presses ? (double)stats.press_latency_total / stats.presses : 0.0, stats.press_latency_max, stats.releases ? (double)stats.release_latency_total / stats.releases : 0.0, stats.release_latency_max, stats.spurious, stats.missed, stats.scans ? (double)stats.ticks / stats.scans : 0.0);
+}
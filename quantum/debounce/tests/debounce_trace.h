@@ -0,0 +1,75 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Switch bounce traces, and replaying them through debounce().
+ *
+ * A trace is the raw level of each switch over time, as a list of edges.
+ * What the debounced matrix should have reported is derived from the trace:
+ * edges of a key closer together than TRACE_SETTLE_TIME form one burst, and
+ * a burst that leaves the key at a new level is one real press or release,
+ * happening at its first edge. Bursts that end where they started are noise.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Longest a switch may chatter and still count as a single press or release
+#define TRACE_SETTLE_TIME 20
+
+typedef struct {
+    uint32_t time;  // ms since the start of the trace
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} trace_edge_t;
+
+typedef struct {
+    std::string               name;
+    std::vector<trace_edge_t> edges;  // in time order
+    uint32_t                  length;
+} bounce_trace_t;
+
+typedef struct {
+    uint32_t keystrokes;  // real presses and releases in the trace, per the rules above
+    uint32_t presses;
+    uint32_t releases;
+    uint32_t press_latency_total;
+    uint32_t press_latency_max;
+    uint32_t release_latency_total;
+    uint32_t release_latency_max;
+    uint32_t spurious;  // reported changes that are not a real press or release
+    uint32_t missed;    // real presses and releases never reported
+    uint32_t scans;
+    uint64_t ticks;  // spent in debounce(), TSC cycles on x86 hosts and ns elsewhere
+} debounce_stats_t;
+
+typedef struct {
+    uint32_t keystrokes;
+    uint32_t max_bounce;  // ms of chatter after each edge, 0 for clean switches
+    uint32_t noise;       // single ms glitches on idle keys, per 1000 ms
+    uint32_t seed;
+} synthetic_trace_config_t;
+
+bounce_trace_t synthetic_trace(const char *name, const synthetic_trace_config_t &config);
+
+// Lines of "<ms> <row> <col> <0|1>", blank lines and lines starting with # are ignored
+bool load_trace(const char *path, bounce_trace_t &trace);
+
+debounce_stats_t replay_trace(const bounce_trace_t &trace, uint32_t scan_interval);
+
+void print_stats(const char *algorithm, const bounce_trace_t &trace, const debounce_stats_t &stats);
@@ -0,0 +1,44 @@
+DEBOUNCE_TEST_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=10
+
+debounce_sym_eager_pk_vc_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5
+debounce_sym_eager_pk_vc_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/sym_eager_pk_vc_tests.cpp \
+	$(QUANTUM_PATH)/debounce/tests/sym_eager_pk_reference.c \
+	$(QUANTUM_PATH)/debounce/sym_eager_pk_vc.c \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_asym_eager_defer_pk_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5
+debounce_asym_eager_defer_pk_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/asym_eager_defer_pk_tests.cpp \
+	$(QUANTUM_PATH)/debounce/asym_eager_defer_pk.c \
+	$(TMK_PATH)/common/test/timer.c
+
+DEBOUNCE_BENCHMARK_INC := $(TOP_DIR)/tests/test_common
+DEBOUNCE_BENCHMARK_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_benchmark_tests.cpp \
+	$(QUANTUM_PATH)/debounce/tests/debounce_trace.cpp \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_benchmark_sym_defer_g_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5 -DDEBOUNCE_ALGORITHM=sym_defer_g
+debounce_benchmark_sym_defer_g_INC := $(DEBOUNCE_BENCHMARK_INC)
+debounce_benchmark_sym_defer_g_SRC := $(DEBOUNCE_BENCHMARK_SRC) $(QUANTUM_PATH)/debounce/sym_defer_g.c
+
+debounce_benchmark_sym_defer_pk_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5 -DDEBOUNCE_ALGORITHM=sym_defer_pk
+debounce_benchmark_sym_defer_pk_INC := $(DEBOUNCE_BENCHMARK_INC)
+debounce_benchmark_sym_defer_pk_SRC := $(DEBOUNCE_BENCHMARK_SRC) $(QUANTUM_PATH)/debounce/sym_defer_pk.c
+
+debounce_benchmark_sym_eager_pk_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5 -DDEBOUNCE_ALGORITHM=sym_eager_pk
+debounce_benchmark_sym_eager_pk_INC := $(DEBOUNCE_BENCHMARK_INC)
+debounce_benchmark_sym_eager_pk_SRC := $(DEBOUNCE_BENCHMARK_SRC) $(QUANTUM_PATH)/debounce/sym_eager_pk.c
+
+debounce_benchmark_sym_eager_pr_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5 -DDEBOUNCE_ALGORITHM=sym_eager_pr
+debounce_benchmark_sym_eager_pr_INC := $(DEBOUNCE_BENCHMARK_INC)
+debounce_benchmark_sym_eager_pr_SRC := $(DEBOUNCE_BENCHMARK_SRC) $(QUANTUM_PATH)/debounce/sym_eager_pr.c
+
+debounce_benchmark_sym_eager_pk_vc_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5 -DDEBOUNCE_ALGORITHM=sym_eager_pk_vc
+debounce_benchmark_sym_eager_pk_vc_INC := $(DEBOUNCE_BENCHMARK_INC)
+debounce_benchmark_sym_eager_pk_vc_SRC := $(DEBOUNCE_BENCHMARK_SRC) $(QUANTUM_PATH)/debounce/sym_eager_pk_vc.c
+
+debounce_benchmark_asym_eager_defer_pk_DEFS := $(DEBOUNCE_TEST_DEFS) -DDEBOUNCE=5 -DDEBOUNCE_ALGORITHM=asym_eager_defer_pk
+debounce_benchmark_asym_eager_defer_pk_INC := $(DEBOUNCE_BENCHMARK_INC)
+debounce_benchmark_asym_eager_defer_pk_SRC := $(DEBOUNCE_BENCHMARK_SRC) $(QUANTUM_PATH)/debounce/asym_eager_defer_pk.c
@@ -0,0 +1,24 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// sym_eager_pk under other names, so tests can run it next to the algorithm under test
+#define debounce reference_debounce
+#define debounce_init reference_debounce_init
+#define debounce_active reference_debounce_active
+#define update_debounce_counters reference_update_debounce_counters
+#define transfer_matrix_values reference_transfer_matrix_values
+
+#include "debounce/sym_eager_pk.c"
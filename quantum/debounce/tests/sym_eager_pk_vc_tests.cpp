@@ -0,0 +1,185 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "matrix.h"
+#include "debounce.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+
+void reference_debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+void reference_debounce_init(uint8_t num_rows);
+}
+
+// The raw state of a switch from time on
+typedef struct {
+    uint32_t time;
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+} trace_edge_t;
+
+// A press and release captured from a chattering switch, times in ms
+static const std::vector<trace_edge_t> recorded_trace = {
+    {10, 0, 0, true},  {11, 0, 0, false}, {12, 0, 0, true},  {14, 0, 0, false}, {15, 0, 0, true},
+    {13, 1, 3, true},  {16, 1, 3, false}, {17, 1, 3, true},
+    {60, 0, 0, false}, {61, 0, 0, true},  {63, 0, 0, false}, {64, 0, 0, true},  {69, 0, 0, false},
+    {80, 1, 3, false}, {84, 1, 3, true},  {86, 1, 3, false},
+    {90, 3, 9, true},  {91, 3, 9, false}, {92, 3, 9, true},  {95, 3, 9, false}, {96, 3, 9, true},  {140, 3, 9, false},
+};
+
+class DebounceVerticalCounterTest : public ::testing::Test {
+   protected:
+    matrix_row_t raw[MATRIX_ROWS]              = {};
+    matrix_row_t cooked[MATRIX_ROWS]           = {};
+    matrix_row_t reference_raw[MATRIX_ROWS]    = {};
+    matrix_row_t reference_cooked[MATRIX_ROWS] = {};
+
+    void SetUp() override {
+        set_time(1000);
+        debounce_init(MATRIX_ROWS);
+        reference_debounce_init(MATRIX_ROWS);
+    }
+
+    void set_key(uint8_t row, uint8_t col, bool pressed) {
+        if (pressed) {
+            raw[row] |= MATRIX_ROW_SHIFTER << col;
+        } else {
+            raw[row] &= ~(MATRIX_ROW_SHIFTER << col);
+        }
+    }
+
+    bool is_pressed(uint8_t row, uint8_t col) { return cooked[row] & (MATRIX_ROW_SHIFTER << col); }
+
+    void scan(void) {
+        bool changed = memcmp(raw, reference_raw, sizeof(raw)) != 0;
+        memcpy(reference_raw, raw, sizeof(raw));
+        debounce(raw, cooked, MATRIX_ROWS, changed);
+        reference_debounce(reference_raw, reference_cooked, MATRIX_ROWS, changed);
+    }
+
+    // Scans every interval ms until end, applying the edges of the trace as their time comes
+    void replay(const std::vector<trace_edge_t> &trace, uint32_t start, uint32_t end, uint32_t interval) {
+        for (uint32_t t = start; t <= end; t += interval) {
+            set_time(t);
+            for (const trace_edge_t &edge : trace) {
+                if (start + edge.time > t - interval && start + edge.time <= t) {
+                    set_key(edge.row, edge.col, edge.pressed);
+                }
+            }
+            scan();
+            ASSERT_EQ(0, memcmp(cooked, reference_cooked, sizeof(cooked))) << "at " << t - start << "ms";
+        }
+    }
+};
+
+TEST_F(DebounceVerticalCounterTest, PressIsReportedImmediately) {
+    set_key(0, 0, true);
+    scan();
+    EXPECT_TRUE(is_pressed(0, 0));
+}
+
+TEST_F(DebounceVerticalCounterTest, ChatterIsIgnoredUntilDebounceElapsed) {
+    set_key(0, 0, true);
+    scan();
+
+    for (uint8_t i = 1; i < DEBOUNCE; i++) {
+        advance_time(1);
+        set_key(0, 0, i % 2);
+        scan();
+        EXPECT_TRUE(is_pressed(0, 0)) << "after " << (int)i << "ms";
+    }
+
+    // Still released once the key unlocks, which is taken at once
+    advance_time(1);
+    set_key(0, 0, false);
+    scan();
+    EXPECT_FALSE(is_pressed(0, 0));
+}
+
+TEST_F(DebounceVerticalCounterTest, ChangeDuringLockIsAppliedWhenUnlocked) {
+    set_key(1, 2, true);
+    scan();
+    advance_time(1);
+    set_key(1, 2, false);
+    scan();
+    EXPECT_TRUE(is_pressed(1, 2));
+
+    advance_time(DEBOUNCE - 1);
+    scan();
+    EXPECT_FALSE(is_pressed(1, 2));
+}
+
+TEST_F(DebounceVerticalCounterTest, KeysAreLockedIndependently) {
+    set_key(2, 0, true);
+    scan();
+    advance_time(2);
+    set_key(2, 9, true);
+    set_key(2, 0, false);
+    scan();
+    EXPECT_TRUE(is_pressed(2, 0));
+    EXPECT_TRUE(is_pressed(2, 9));
+
+    advance_time(DEBOUNCE - 2);
+    scan();
+    EXPECT_FALSE(is_pressed(2, 0));
+    EXPECT_TRUE(is_pressed(2, 9));
+}
+
+TEST_F(DebounceVerticalCounterTest, LongGapBetweenScansUnlocks) {
+    set_key(3, 4, true);
+    scan();
+    advance_time(1000);
+    set_key(3, 4, false);
+    scan();
+    EXPECT_FALSE(is_pressed(3, 4));
+}
+
+TEST_F(DebounceVerticalCounterTest, MatchesSymEagerPkOnRecordedTrace) { replay(recorded_trace, 1000, 1200, 1); }
+
+TEST_F(DebounceVerticalCounterTest, MatchesSymEagerPkWithSlowScans) { replay(recorded_trace, 1000, 1200, 3); }
+
+TEST_F(DebounceVerticalCounterTest, MatchesSymEagerPkAcrossTimerWrap) { replay(recorded_trace, 0xFFFF - 50, 0xFFFF + 150, 1); }
+
+TEST_F(DebounceVerticalCounterTest, MatchesSymEagerPkOnRandomChatter) {
+    std::mt19937                           random(1234);
+    std::uniform_int_distribution<uint8_t> row(0, MATRIX_ROWS - 1);
+    std::uniform_int_distribution<uint8_t> col(0, MATRIX_COLS - 1);
+    std::uniform_int_distribution<int>     percent(0, 99);
+
+    uint32_t t = 1000;
+    for (int i = 0; i < 20000; i++) {
+        // Mostly 1ms scans, with the odd repeated timestamp and slow scan
+        int roll = percent(random);
+        t += roll < 10 ? 0 : roll < 90 ? 1 : 2 + roll % 4;
+        set_time(t);
+
+        int flips = percent(random) < 30 ? 1 + percent(random) % 3 : 0;
+        for (int f = 0; f < flips; f++) {
+            uint8_t r = row(random), c = col(random);
+            set_key(r, c, !(raw[r] & (MATRIX_ROW_SHIFTER << c)));
+        }
+
+        scan();
+        ASSERT_EQ(0, memcmp(cooked, reference_cooked, sizeof(cooked))) << "at scan " << i;
+    }
+}
@@ -0,0 +1,8 @@
+TEST_LIST += debounce_sym_eager_pk_vc
+TEST_LIST += debounce_asym_eager_defer_pk
+TEST_LIST += debounce_benchmark_sym_defer_g
+TEST_LIST += debounce_benchmark_sym_defer_pk
+TEST_LIST += debounce_benchmark_sym_eager_pk
+TEST_LIST += debounce_benchmark_sym_eager_pr
+TEST_LIST += debounce_benchmark_sym_eager_pk_vc
+TEST_LIST += debounce_benchmark_asym_eager_defer_pk
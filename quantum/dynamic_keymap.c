@@ -21,6 +21,7 @@
 #include "quantum.h"  // for send_string()
 #include "dynamic_keymap.h"
 #include "via.h"  // for default VIA_EEPROM_ADDR_END
+#include <string.h>
 
 #ifndef DYNAMIC_KEYMAP_LAYER_COUNT
 #    define DYNAMIC_KEYMAP_LAYER_COUNT 4
@@ -47,6 +48,14 @@
 #    error DYNAMIC_KEYMAP_EEPROM_MAX_ADDR must be less than 65536
 #endif
 
+// The STM32 flash emulated EEPROM ignores writes beyond its size
+#ifdef STM32_EEPROM_ENABLE
+#    include "eeprom_stm32.h"
+#    if DYNAMIC_KEYMAP_EEPROM_MAX_ADDR >= FEE_DENSITY_BYTES
+#        error DYNAMIC_KEYMAP_EEPROM_MAX_ADDR must be less than FEE_DENSITY_BYTES
+#    endif
+#endif
+
 // If DYNAMIC_KEYMAP_EEPROM_ADDR not explicitly defined in config.h,
 // default it start after VIA_EEPROM_CUSTOM_ADDR+VIA_EEPROM_CUSTOM_SIZE
 #ifndef DYNAMIC_KEYMAP_EEPROM_ADDR
@@ -77,6 +86,45 @@
 #    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
 #endif
 
+// Optional write-through RAM copy of the keymap layers, so that key lookups
+// never touch EEPROM. Costs DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2
+// bytes of RAM, so it is meant for MCUs with EEPROM emulation or external EEPROM.
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+static uint16_t dynamic_keymap_cache[DYNAMIC_KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+
+static void dynamic_keymap_cache_load(void) {
+    uint16_t *keycode = &dynamic_keymap_cache[0][0][0];
+    eeprom_read_block(dynamic_keymap_cache, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, sizeof(dynamic_keymap_cache));
+    for (uint16_t i = 0; i < DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS; i++) {
+        // Big endian, same as in EEPROM
+        uint8_t *bytes = (uint8_t *)keycode;
+        *keycode       = (bytes[0] << 8) | bytes[1];
+        keycode++;
+    }
+}
+
+static uint8_t dynamic_keymap_cache_read_byte(uint16_t offset) {
+    uint16_t keycode = *(&dynamic_keymap_cache[0][0][0] + (offset >> 1));
+    return (offset & 1) ? (keycode & 0xFF) : (keycode >> 8);
+}
+
+static void dynamic_keymap_cache_update_byte(uint16_t offset, uint8_t data) {
+    uint16_t *keycode = &dynamic_keymap_cache[0][0][0] + (offset >> 1);
+    if (offset & 1) {
+        *keycode = (*keycode & 0xFF00) | data;
+    } else {
+        *keycode = (*keycode & 0x00FF) | (data << 8);
+    }
+}
+#endif
+
+void dynamic_keymap_init(void) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    // Filled once here so that key lookups never have to check for it
+    dynamic_keymap_cache_load();
+#endif
+}
+
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
@@ -85,59 +133,78 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
 }
 
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
-    void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    return dynamic_keymap_cache[layer][row][column];
+#else
+    void *  address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
+    uint8_t data[2];
+    eeprom_read_block(data, address, sizeof(data));
     // Big endian, so we can read/write EEPROM directly from host if we want
-    uint16_t keycode = eeprom_read_byte(address) << 8;
-    keycode |= eeprom_read_byte(address + 1);
-    return keycode;
+    return (data[0] << 8) | data[1];
+#endif
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    uint8_t data[2] = {keycode >> 8, keycode & 0xFF};
+    eeprom_update_block(data, address, sizeof(data));
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    dynamic_keymap_cache[layer][row][column] = keycode;
+#endif
 }
 
 void dynamic_keymap_reset(void) {
     // Reset the keymaps in EEPROM to what is in flash.
     // All keyboards using dynamic keymaps should define a layout
     // for the same number of layers as DYNAMIC_KEYMAP_LAYER_COUNT.
+    uint8_t data[MATRIX_COLS * 2];
     for (int layer = 0; layer < DYNAMIC_KEYMAP_LAYER_COUNT; layer++) {
         for (int row = 0; row < MATRIX_ROWS; row++) {
             for (int column = 0; column < MATRIX_COLS; column++) {
-                dynamic_keymap_set_keycode(layer, row, column, pgm_read_word(&keymaps[layer][row][column]));
+                uint16_t keycode     = pgm_read_word(&keymaps[layer][row][column]);
+                data[column * 2]     = keycode >> 8;
+                data[column * 2 + 1] = keycode & 0xFF;
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+                dynamic_keymap_cache[layer][row][column] = keycode;
+#endif
             }
+            // One transfer per row rather than per key
+            eeprom_update_block(data, dynamic_keymap_key_to_eeprom_address(layer, row, 0), sizeof(data));
         }
     }
 }
 
+// Number of bytes of a size byte request at offset that fall inside a region of region_size bytes
+static uint16_t dynamic_keymap_clamp_size(uint16_t offset, uint16_t size, uint16_t region_size) {
+    if (offset >= region_size) {
+        return 0;
+    }
+    return (size < region_size - offset) ? size : region_size - offset;
+}
+
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
+    uint16_t length                     = dynamic_keymap_clamp_size(offset, size, dynamic_keymap_eeprom_size);
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = dynamic_keymap_cache_read_byte(offset + i);
     }
+#else
+    eeprom_read_block(data, (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset), length);
+#endif
+    memset(data + length, 0x00, size - length);
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
     uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
+    uint16_t length                     = dynamic_keymap_clamp_size(offset, size, dynamic_keymap_eeprom_size);
+    eeprom_update_block(data, (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset), length);
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    for (uint16_t i = 0; i < length; i++) {
+        dynamic_keymap_cache_update_byte(offset + i, data[i]);
     }
+#endif
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -154,37 +221,23 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *target = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            *target = eeprom_read_byte(source);
-        } else {
-            *target = 0x00;
-        }
-        source++;
-        target++;
-    }
+    uint16_t length = dynamic_keymap_clamp_size(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    eeprom_read_block(data, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), length);
+    memset(data + length, 0x00, size - length);
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
-    uint8_t *source = data;
-    for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
-            eeprom_update_byte(target, *source);
-        }
-        source++;
-        target++;
-    }
+    uint16_t length = dynamic_keymap_clamp_size(offset, size, DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    eeprom_update_block(data, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), length);
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
-    while (p != end) {
-        eeprom_update_byte(p, 0);
-        ++p;
+    uint8_t  zeros[32] = {0};
+    uint16_t offset    = 0;
+    while (offset < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
+        uint16_t length = dynamic_keymap_clamp_size(offset, sizeof(zeros), DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+        eeprom_update_block(zeros, (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset), length);
+        offset += length;
     }
 }
 
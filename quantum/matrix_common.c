@@ -85,6 +85,81 @@ uint8_t matrix_key_count(void) {
 
 __attribute__((weak)) void matrix_io_delay(void) { wait_us(MATRIX_IO_DELAY); }
 
+#ifdef MATRIX_SCAN_INTERRUPT
+#    ifndef MATRIX_WAKEUP_FOLLOWUP_SCANS
+#        define MATRIX_WAKEUP_FOLLOWUP_SCANS 16
+#    endif
+
+static volatile bool matrix_wakeup_flag    = false;
+static bool          matrix_idle           = false;
+static bool          matrix_idle_armed     = false;
+static uint8_t       matrix_followup_scans = MATRIX_WAKEUP_FOLLOWUP_SCANS;
+
+__attribute__((weak)) bool matrix_wakeup_arm(void) { return false; }
+
+__attribute__((weak)) void matrix_wakeup_disarm(void) {}
+
+__attribute__((weak)) void matrix_wakeup_wait(void) {}
+
+/* Called from the pin change interrupt handler */
+void matrix_wakeup_signal(void) { matrix_wakeup_flag = true; }
+
+/* Returns true if the matrix needs a full scan, false while it is idle */
+bool matrix_wakeup_poll(void) {
+    if (!matrix_idle) {
+        return true;
+    }
+
+    if (!matrix_wakeup_flag) {
+        if (matrix_idle_armed) {
+            matrix_wakeup_wait();
+            if (!matrix_wakeup_flag) {
+                return false;
+            }
+        } else if (!matrix_idle_probe()) {
+            return false;
+        }
+    }
+
+    if (matrix_idle_armed) {
+        matrix_wakeup_disarm();
+    }
+    matrix_idle_exit();
+    matrix_idle           = false;
+    matrix_followup_scans = MATRIX_WAKEUP_FOLLOWUP_SCANS;
+    return true;
+}
+
+/* Goes idle once nothing is pressed, the debounced state has settled
+ * and MATRIX_WAKEUP_FOLLOWUP_SCANS quiet scans have passed */
+void matrix_wakeup_update(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool quiet = !changed;
+    for (uint8_t i = 0; quiet && i < num_rows; i++) {
+        quiet = !(raw[i] | cooked[i]);
+    }
+
+    if (!quiet) {
+        matrix_followup_scans = MATRIX_WAKEUP_FOLLOWUP_SCANS;
+        return;
+    }
+    if (matrix_followup_scans) {
+        matrix_followup_scans--;
+        return;
+    }
+
+    matrix_wakeup_flag = false;
+    matrix_idle_enter();
+    matrix_io_delay();
+    matrix_idle_armed = matrix_wakeup_arm();
+    matrix_idle       = true;
+
+    // catch a press that landed before the interrupt was armed
+    if (matrix_idle_probe()) {
+        matrix_wakeup_flag = true;
+    }
+}
+#endif
+
 // CUSTOM MATRIX 'LITE'
 __attribute__((weak)) void matrix_init_custom(void) {}
 
@@ -16,6 +16,7 @@
 
 #include "print.h"
 #include "process_combo.h"
+#include <string.h>
 
 #ifndef COMBO_VARIABLE_LEN
 __attribute__((weak)) combo_t key_combos[COMBO_COUNT] = {};
@@ -26,20 +27,197 @@ extern int      COMBO_LEN;
 
 __attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
 
-static uint16_t timer               = 0;
-static uint16_t current_combo_index = 0;
-static bool     drop_buffer         = false;
-static bool     is_active           = false;
-static bool     b_combo_enable      = true;  // defaults to enabled
+#ifdef COMBO_TERM_PER_COMBO
+__attribute__((weak)) uint16_t get_combo_term(uint16_t combo_index, combo_t *combo) { return COMBO_TERM; }
+#    define GET_COMBO_TERM(index, combo) get_combo_term(index, combo)
+#else
+#    define GET_COMBO_TERM(index, combo) COMBO_TERM
+#endif
+
+/* Combos see key events before tap-hold keys are resolved. A press that
+ * could be part of a combo is held back in key_buffer. Combos it completes
+ * wait in combo_buffer while a longer combo including them could still
+ * complete. Anything else, or running out of time, settles the buffer:
+ * the waiting combos fire, and every other press is replayed into tapping,
+ * from where it goes through the whole pipeline as if it was never held.
+ */
+#define COMBO_NONE 0xFFFF
 
-static uint8_t buffer_size = 0;
-#ifdef COMBO_ALLOW_ACTION_KEYS
-static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
+#ifdef EXTRA_EXTRA_LONG_COMBOS
+typedef uint32_t combo_state_t;
+#elif EXTRA_LONG_COMBOS
+typedef uint16_t combo_state_t;
 #else
-static uint16_t key_buffer[MAX_COMBO_LENGTH];
+typedef uint8_t combo_state_t;
+#endif
+
+typedef struct {
+    keyrecord_t record;
+    uint16_t    keycode;
+    uint16_t    combo_index;  // the combo it fired, if any
+} queued_key_t;
+
+static uint16_t timer          = 0;     // last press put in key_buffer
+static uint16_t longest_term   = 0;     // of the combos with a key in key_buffer
+static bool     b_combo_enable = true;  // defaults to enabled
+
+static queued_key_t key_buffer[COMBO_KEY_BUFFER_LENGTH];
+static uint8_t      key_buffer_size = 0;
+static uint16_t     combo_buffer[COMBO_BUFFER_LENGTH];
+static uint8_t      combo_buffer_size = 0;
+
+#if COMBO_INDEX_SIZE == 0 && !defined(COMBO_NO_INDEX)
+#    define COMBO_NO_INDEX
+#endif
+
+#ifndef COMBO_NO_INDEX
+/* Which combos each keycode is part of, built on first use so that a key
+ * event only looks at the combos it can complete. Sorted by keycode, then
+ * by combo, so combos are still processed in the order they are declared.
+ */
+#    if COMBO_COUNT < 256 && !defined(COMBO_VARIABLE_LEN)
+typedef uint8_t combo_index_t;
+#    else
+typedef uint16_t combo_index_t;
+#    endif
+
+typedef struct {
+    uint16_t      keycode;
+    combo_index_t combo_index;
+} combo_key_t;
+
+static combo_key_t combo_keys[COMBO_INDEX_SIZE];
+static uint16_t    combo_keys_count = 0;
+static bool        combo_keys_built = false;
+static bool        combo_keys_valid = false;  // all keys fit, so the index can be used
+#endif
+
+static inline uint16_t combo_count(void) {
+#ifndef COMBO_VARIABLE_LEN
+    return COMBO_COUNT;
+#else
+    return COMBO_LEN;
+#endif
+}
+
+#ifndef COMBO_NO_INDEX
+// Index of the first entry for keycode, or where it would be
+static uint16_t find_combo_key(uint16_t keycode) {
+    uint16_t low = 0, high = combo_keys_count;
+    while (low < high) {
+        uint16_t middle = low + (high - low) / 2;
+        if (combo_keys[middle].keycode < keycode) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void build_combo_index(void) {
+    uint16_t count = 0;
+
+    combo_keys_built = true;
+    for (uint16_t i = 0; i < combo_count(); i++) {
+        for (const uint16_t *keys = key_combos[i].keys; pgm_read_word(keys) != COMBO_END; keys++) {
+            count++;
+        }
+    }
+    // Without the room for an index every combo is looked at, as before
+    if (count == 0 || count > COMBO_INDEX_SIZE) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < combo_count(); i++) {
+        for (const uint16_t *keys = key_combos[i].keys;; keys++) {
+            uint16_t keycode = pgm_read_word(keys);
+            if (keycode == COMBO_END) {
+                break;
+            }
+
+            // Combos are added in order, so this one goes after any others with the keycode
+            uint16_t position = find_combo_key(keycode);
+            while (position < combo_keys_count && combo_keys[position].keycode == keycode) {
+                position++;
+            }
+            if (position > 0 && combo_keys[position - 1].keycode == keycode && combo_keys[position - 1].combo_index == i) {
+                continue;  // the keycode is in this combo twice
+            }
+            memmove(&combo_keys[position + 1], &combo_keys[position], (combo_keys_count - position) * sizeof(combo_key_t));
+            combo_keys[position] = (combo_key_t){.keycode = keycode, .combo_index = i};
+            combo_keys_count++;
+        }
+    }
+    combo_keys_valid = true;
+}
 #endif
 
-static inline void send_combo(uint16_t action, bool pressed) {
+/* Walks the combos that may contain keycode, which is all of them without the index:
+ *     for (uint16_t cursor = first_combo(keycode), index; (index = next_combo(keycode, &cursor)) != COMBO_NONE;)
+ */
+static uint16_t first_combo(uint16_t keycode) {
+#ifndef COMBO_NO_INDEX
+    if (!combo_keys_built) {
+        build_combo_index();
+    }
+    if (combo_keys_valid) {
+        return find_combo_key(keycode);
+    }
+#endif
+    return 0;
+}
+
+static uint16_t next_combo(uint16_t keycode, uint16_t *cursor) {
+#ifndef COMBO_NO_INDEX
+    if (combo_keys_valid) {
+        if (*cursor < combo_keys_count && combo_keys[*cursor].keycode == keycode) {
+            return combo_keys[(*cursor)++].combo_index;
+        }
+        return COMBO_NONE;
+    }
+#endif
+    return *cursor < combo_count() ? (*cursor)++ : COMBO_NONE;
+}
+
+#define FOR_EACH_COMBO_WITH(keycode, index) for (uint16_t cursor = first_combo(keycode), index; (index = next_combo(keycode, &cursor)) != COMBO_NONE;)
+
+// Bits of the combo's keys that are keycode
+static combo_state_t combo_key_mask(const combo_t *combo, uint16_t keycode) {
+    combo_state_t mask = 0;
+    for (uint8_t i = 0; pgm_read_word(&combo->keys[i]) != COMBO_END; i++) {
+        if (pgm_read_word(&combo->keys[i]) == keycode) {
+            mask |= (combo_state_t)1 << i;
+        }
+    }
+    return mask;
+}
+
+static uint8_t combo_key_count(const combo_t *combo) {
+    uint8_t count = 0;
+    while (pgm_read_word(&combo->keys[count]) != COMBO_END) {
+        count++;
+    }
+    return count;
+}
+
+static bool combo_is_complete(const combo_t *combo) {
+    uint8_t count = combo_key_count(combo);
+    return combo->state == (count < sizeof(combo_state_t) * 8 ? (combo_state_t)((1UL << count) - 1) : (combo_state_t)-1);
+}
+
+// Whether every key of inner is also one of outer, or just some of them
+static bool combo_has_keys_of(const combo_t *outer, const combo_t *inner, bool all) {
+    for (const uint16_t *keys = inner->keys; pgm_read_word(keys) != COMBO_END; keys++) {
+        if ((combo_key_mask(outer, pgm_read_word(keys)) != 0) != all) {
+            return !all;
+        }
+    }
+    return all;
+}
+
+static void send_combo(uint16_t index, bool pressed) {
+    uint16_t action = key_combos[index].keycode;
     if (action) {
         if (pressed) {
             register_code16(action);
@@ -47,85 +225,163 @@ static inline void send_combo(uint16_t action, bool pressed) {
             unregister_code16(action);
         }
     } else {
-        process_combo_event(current_combo_index, pressed);
+        process_combo_event(index, pressed);
     }
 }
 
-static inline void dump_key_buffer(bool emit) {
-    if (buffer_size == 0) {
-        return;
+/* Fires the waiting combos, each in place of the first of its keys, and
+ * replays the rest of the buffered presses.
+ */
+static void apply_combos(void) {
+    queued_key_t queue[COMBO_KEY_BUFFER_LENGTH];
+    uint8_t      size = key_buffer_size;
+
+    for (uint8_t i = 0; i < combo_buffer_size; i++) {
+        combo_t *combo = &key_combos[combo_buffer[i]];
+        for (const uint16_t *keys = combo->keys; pgm_read_word(keys) != COMBO_END; keys++) {
+            for (uint8_t k = 0; k < size; k++) {
+                if (key_buffer[k].combo_index == COMBO_NONE && key_buffer[k].keycode == pgm_read_word(keys)) {
+                    key_buffer[k].combo_index = combo_buffer[i];
+                    break;
+                }
+            }
+        }
+        combo->active = true;
     }
 
-    if (emit) {
-        for (uint8_t i = 0; i < buffer_size; i++) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            const action_t action = store_or_get_action(key_buffer[i].event.pressed, key_buffer[i].event.key);
-            process_action(&(key_buffer[i]), action);
+    // What the buffered keys did to combos that didn't fire is forgotten
+    for (uint8_t k = 0; k < size; k++) {
+        FOR_EACH_COMBO_WITH(key_buffer[k].keycode, index) {
+            if (!key_combos[index].active) {
+                key_combos[index].state = 0;
+            }
+            key_combos[index].disabled = false;
+        }
+    }
+
+    // Done before replaying, in case that ends up back in here through combo_disable()
+    memcpy(queue, key_buffer, size * sizeof(queued_key_t));
+    key_buffer_size = combo_buffer_size = 0;
+    longest_term                        = 0;
+
+    for (uint8_t k = 0; k < size; k++) {
+        uint16_t index = queue[k].combo_index;
+        if (index == COMBO_NONE) {
+#ifndef NO_ACTION_TAPPING
+            action_tapping_process(queue[k].record);
 #else
-            register_code16(key_buffer[i]);
-            send_keyboard_report();
+            process_record(&queue[k].record);
 #endif
+            continue;
         }
-    }
 
-    buffer_size = 0;
+        bool fired = false;
+        for (uint8_t j = 0; j < k; j++) {
+            fired |= queue[j].combo_index == index;
+        }
+        if (!fired) {
+            send_combo(index, true);
+        }
+    }
 }
 
-#define ALL_COMBO_KEYS_ARE_DOWN (((1 << count) - 1) == combo->state)
-#define KEY_STATE_DOWN(key)         \
-    do {                            \
-        combo->state |= (1 << key); \
-    } while (0)
-#define KEY_STATE_UP(key)            \
-    do {                             \
-        combo->state &= ~(1 << key); \
-    } while (0)
+// Sets keycode down in the combos that can still complete, true if there were any
+static bool press_combo_keys(uint16_t keycode) {
+    bool is_combo_key = false;
 
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) {
-    uint8_t  count = 0;
-    uint16_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys;; ++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
-    }
+    FOR_EACH_COMBO_WITH(keycode, index) {
+        combo_t *     combo = &key_combos[index];
+        combo_state_t mask  = combo_key_mask(combo, keycode);
+        if (!mask || combo->active || combo->disabled) {
+            continue;
+        }
 
-    /* Continue processing if not a combo key */
-    if (-1 == (int8_t)index) return false;
+        uint16_t term = GET_COMBO_TERM(index, combo);
+        if (combo->state && timer_elapsed(timer) > term) {
+            combo->disabled = true;
+            continue;
+        }
 
-    bool is_combo_active = is_active;
+        combo->state |= mask;
+        if (longest_term < term) {
+            longest_term = term;
+        }
+        is_combo_key = true;
+    }
+    return is_combo_key;
+}
 
-    if (record->event.pressed) {
-        KEY_STATE_DOWN(index);
+/* Queues the combos keycode completed. A combo replaces the shorter ones it
+ * overlaps, and loses to one at least as long.
+ */
+static void queue_completed_combos(uint16_t keycode) {
+    FOR_EACH_COMBO_WITH(keycode, index) {
+        combo_t *combo = &key_combos[index];
+        if (!combo_key_mask(combo, keycode) || combo->active || combo->disabled || !combo_is_complete(combo)) {
+            continue;
+        }
 
-        if (is_combo_active) {
-            if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
-                send_combo(combo->keycode, true);
-                drop_buffer = true;
+        uint8_t count  = combo_key_count(combo);
+        bool    queued = false;
+        for (uint8_t i = 0; i < combo_buffer_size && !queued && !combo->disabled;) {
+            combo_t *other = &key_combos[combo_buffer[i]];
+            if (combo_buffer[i] == index) {
+                queued = true;  // completed again by a repeated keycode
+            } else if (!combo_has_keys_of(other, combo, false)) {
+                i++;
+            } else if (combo_key_count(other) >= count) {
+                combo->disabled = true;
+            } else {
+                other->disabled = true;
+                combo_buffer_size--;
+                memmove(&combo_buffer[i], &combo_buffer[i + 1], (combo_buffer_size - i) * sizeof(uint16_t));
             }
         }
-    } else {
-        if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was released */
-            send_combo(combo->keycode, false);
-        } else {
-            /* continue processing without immediately returning */
-            is_combo_active = false;
-        }
 
-        KEY_STATE_UP(index);
+        if (!queued && !combo->disabled && combo_buffer_size < COMBO_BUFFER_LENGTH) {
+            combo_buffer[combo_buffer_size++] = index;
+        }
     }
+}
 
-    return is_combo_active;
+// Whether a longer combo containing a waiting one might still complete
+static bool longer_combo_possible(void) {
+    for (uint8_t i = 0; i < combo_buffer_size; i++) {
+        combo_t *waiting = &key_combos[combo_buffer[i]];
+        uint8_t  count   = combo_key_count(waiting);
+        FOR_EACH_COMBO_WITH(pgm_read_word(waiting->keys), index) {
+            combo_t *combo = &key_combos[index];
+            if (combo != waiting && !combo->active && !combo->disabled && combo_key_count(combo) > count && combo_has_keys_of(combo, waiting, true)) {
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == combo->state)
+// Lets go of keycode in the combos that fired with it, true if there were any
+static bool release_combo_keys(uint16_t keycode) {
+    bool is_combo_key = false;
 
-bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    drop_buffer                = false;
-    bool no_combo_keys_pressed = true;
+    FOR_EACH_COMBO_WITH(keycode, index) {
+        combo_t *     combo = &key_combos[index];
+        combo_state_t mask  = combo_key_mask(combo, keycode) & combo->state;
+        if (!mask || !combo->active) {
+            continue;
+        }
 
+        // The first key released releases the combo
+        if (combo_is_complete(combo)) {
+            send_combo(index, false);
+        }
+        combo->state &= ~mask;
+        combo->active = combo->state != 0;
+        is_combo_key  = true;
+    }
+    return is_combo_key;
+}
+
+bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
         return true;
@@ -141,65 +397,40 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
         return true;
     }
 
-    if (!is_combo_enabled()) {
-        return true;
-    }
-#ifndef COMBO_VARIABLE_LEN
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-#else
-    for (current_combo_index = 0; current_combo_index < COMBO_LEN; ++current_combo_index) {
-#endif
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-        no_combo_keys_pressed = no_combo_keys_pressed && NO_COMBO_KEYS_ARE_DOWN;
-    }
-
-    if (drop_buffer) {
-        /* buffer is only dropped when we complete a combo, so we refresh the timer
-         * here */
-        timer = timer_read();
-        dump_key_buffer(false);
-    } else if (!is_combo_key) {
-        /* if no combos claim the key we need to emit the keybuffer */
-        dump_key_buffer(true);
-
-        // reset state if there are no combo keys pressed at all
-        if (no_combo_keys_pressed) {
-            timer     = 0;
-            is_active = true;
-        }
-    } else if (record->event.pressed && is_active) {
-        /* otherwise the key is consumed and placed in the buffer */
-        timer = timer_read();
-
-        if (buffer_size < MAX_COMBO_LENGTH) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            key_buffer[buffer_size++] = *record;
-#else
-            key_buffer[buffer_size++] = keycode;
-#endif
+    if (is_combo_enabled() && record->event.pressed) {
+        if (key_buffer_size == COMBO_KEY_BUFFER_LENGTH) {
+            apply_combos();
+        }
+        if (press_combo_keys(keycode)) {
+            key_buffer[key_buffer_size++] = (queued_key_t){.record = *record, .keycode = keycode, .combo_index = COMBO_NONE};
+            timer                         = timer_read();
+            queue_completed_combos(keycode);
+            if (combo_buffer_size && !longer_combo_possible()) {
+                apply_combos();
+            }
+            return false;
         }
     }
 
-    return !is_combo_key;
+    // Anything else settles the buffered keys first, so events stay in order
+    if (key_buffer_size) {
+        apply_combos();
+    }
+    return record->event.pressed || !release_combo_keys(keycode);
 }
 
 void matrix_scan_combo(void) {
-    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
-        /* This disables the combo, meaning key events for this
-         * combo will be handled by the next processors in the chain
-         */
-        is_active = false;
-        dump_key_buffer(true);
+    if (key_buffer_size && timer_elapsed(timer) > longest_term) {
+        apply_combos();
     }
 }
 
 void combo_enable(void) { b_combo_enable = true; }
 
 void combo_disable(void) {
-    b_combo_enable = is_active = false;
-    timer                      = 0;
-    dump_key_buffer(true);
+    b_combo_enable    = false;
+    combo_buffer_size = 0;
+    apply_combos();
 }
 
 void combo_toggle(void) {
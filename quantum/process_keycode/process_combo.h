@@ -38,6 +38,8 @@ typedef struct {
 #else
     uint8_t state;
 #endif
+    bool disabled : 1;  // took too long to complete, or lost to a longer combo
+    bool active : 1;    // fired, and some of its keys are still down
 } combo_t;
 
 #define COMBO(ck, ca) \
@@ -52,10 +54,31 @@ typedef struct {
 #ifndef COMBO_TERM
 #    define COMBO_TERM TAPPING_TERM
 #endif
+// Presses held back while combos are decided
+#ifndef COMBO_KEY_BUFFER_LENGTH
+#    define COMBO_KEY_BUFFER_LENGTH MAX_COMBO_LENGTH
+#endif
+// Fully pressed combos waiting for a longer one to complete
+#ifndef COMBO_BUFFER_LENGTH
+#    define COMBO_BUFFER_LENGTH 4
+#endif
+// Keys of all combos together the keycode index has room for, 0 to always check every combo
+#ifndef COMBO_INDEX_SIZE
+#    if defined(__AVR__)
+#        define COMBO_INDEX_SIZE 0
+#    elif defined(COMBO_VARIABLE_LEN)
+#        define COMBO_INDEX_SIZE 64
+#    else
+#        define COMBO_INDEX_SIZE (COMBO_COUNT * 3)
+#    endif
+#endif
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
 void matrix_scan_combo(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
+#ifdef COMBO_TERM_PER_COMBO
+uint16_t get_combo_term(uint16_t combo_index, combo_t *combo);
+#endif
 
 void combo_enable(void);
 void combo_disable(void);
@@ -75,7 +75,10 @@ void cycle_unicode_input_mode(int8_t offset) {
 #endif
 }
 
-void persist_unicode_input_mode(void) { eeprom_update_byte(EECONFIG_UNICODEMODE, unicode_config.input_mode); }
+void persist_unicode_input_mode(void) {
+    uint8_t input_mode = unicode_config.input_mode;
+    eeconfig_update_deferred(&input_mode, EECONFIG_UNICODEMODE, sizeof(input_mode));
+}
 
 __attribute__((weak)) void unicode_input_start(void) {
     unicode_saved_caps_lock = host_keyboard_led_state().caps_lock;
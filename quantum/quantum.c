@@ -16,6 +16,7 @@
 
 #include <ctype.h>
 #include "quantum.h"
+#include "profiler.h"
 
 #ifdef BLUETOOTH_ENABLE
 #    include "outputselect.h"
@@ -125,6 +126,9 @@ __attribute__((weak)) void post_process_record_user(uint16_t keycode, keyrecord_
 
 void reset_keyboard(void) {
     clear_keyboard();
+#ifdef EECONFIG_DEFERRED_WRITE
+    eeconfig_flush();
+#endif
 #if defined(MIDI_ENABLE) && defined(MIDI_BASIC)
     process_midi_all_notes_off();
 #endif
@@ -180,6 +184,20 @@ void post_process_record_quantum(keyrecord_t *record) {
     post_process_record_kb(keycode, record);
 }
 
+/* Sees key events before tap-hold keys are resolved. Events held back
+    here are replayed from the same point later, so they still go through
+    tapping and the rest of the chain.                                  */
+bool pre_process_record_quantum(keyrecord_t *record) {
+    if (!(
+#ifdef COMBO_ENABLE
+            process_combo(get_record_keycode(record, true), record) &&
+#endif
+            true)) {
+        return false;
+    }
+    return true;
+}
+
 /* Core keycode function, hands off handling to other functions,
     then processes internal quantum keycodes, and then processes
     ACTIONs.                                                      */
@@ -259,9 +277,6 @@ bool process_record_quantum(keyrecord_t *record) {
 #ifdef LEADER_ENABLE
             process_leader(keycode, record) &&
 #endif
-#ifdef COMBO_ENABLE
-            process_combo(keycode, record) &&
-#endif
 #ifdef PRINTING_ENABLE
             process_printer(keycode, record) &&
 #endif
@@ -660,7 +675,9 @@ void matrix_scan_quantum() {
 #endif
 
 #ifdef RGB_MATRIX_ENABLE
+    PROFILE_START(rgb_matrix);
     rgb_matrix_task();
+    PROFILE_END(rgb_matrix, PROFILE_RGB_MATRIX);
 #endif
 
 #ifdef WPM_ENABLE
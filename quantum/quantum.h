@@ -49,6 +49,10 @@
 #    include "rgb_matrix.h"
 #endif
 
+#if defined(SPLIT_KEYBOARD) && defined(SPLIT_TRANSPORT_OBJECTS)
+#    include "split_objects.h"
+#endif
+
 #include "action_layer.h"
 #include "eeconfig.h"
 #include "bootloader.h"
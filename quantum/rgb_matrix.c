@@ -33,13 +33,128 @@ const point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 
 __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
 
+// Polar position of an LED around k_rgb_matrix_center
+static inline uint8_t rgb_matrix_compute_led_dist(uint8_t i) {
+    int16_t dx = g_led_config.point[i].x - k_rgb_matrix_center.x;
+    int16_t dy = g_led_config.point[i].y - k_rgb_matrix_center.y;
+    return sqrt16(dx * dx + dy * dy);
+}
+
+static inline uint8_t rgb_matrix_compute_led_angle(uint8_t i) {
+    int16_t dx = g_led_config.point[i].x - k_rgb_matrix_center.x;
+    int16_t dy = g_led_config.point[i].y - k_rgb_matrix_center.y;
+    return atan2_8(dy, dx);
+}
+
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+#    define rgb_matrix_led_dist(i) (g_led_geometry[i].dist)
+#    define rgb_matrix_led_angle(i) (g_led_geometry[i].angle)
+#else
+#    define rgb_matrix_led_dist(i) rgb_matrix_compute_led_dist(i)
+#    define rgb_matrix_led_angle(i) rgb_matrix_compute_led_angle(i)
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
+// Runners hand their colors to rgb_matrix_set_hsv() and call rgb_matrix_flush_hsv() once done
+#ifdef RGB_MATRIX_HSV_BATCH
+#    ifndef RGB_MATRIX_HSV_BATCH_SIZE
+#        define RGB_MATRIX_HSV_BATCH_SIZE 16
+#    endif
+
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_n(const HSV *hsv, RGB *rgb, uint8_t n) { hsv_to_rgb_n(hsv, rgb, n); }
+
+static struct {
+    uint8_t count;
+    uint8_t index[RGB_MATRIX_HSV_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_HSV_BATCH_SIZE];
+} rgb_hsv_batch;
+
+static void rgb_matrix_flush_hsv(void) {
+    RGB rgb[RGB_MATRIX_HSV_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_n(rgb_hsv_batch.hsv, rgb, rgb_hsv_batch.count);
+    for (uint8_t j = 0; j < rgb_hsv_batch.count; j++) {
+        rgb_matrix_set_color(rgb_hsv_batch.index[j], rgb[j].r, rgb[j].g, rgb[j].b);
+    }
+    rgb_hsv_batch.count = 0;
+}
+
+static inline void rgb_matrix_set_hsv(uint8_t index, HSV hsv) {
+    rgb_hsv_batch.index[rgb_hsv_batch.count] = index;
+    rgb_hsv_batch.hsv[rgb_hsv_batch.count]   = hsv;
+    if (++rgb_hsv_batch.count == RGB_MATRIX_HSV_BATCH_SIZE) {
+        rgb_matrix_flush_hsv();
+    }
+}
+#else
+static inline void rgb_matrix_set_hsv(uint8_t index, HSV hsv) {
+    RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
+    rgb_matrix_set_color(index, rgb.r, rgb.g, rgb.b);
+}
+
+static inline void rgb_matrix_flush_hsv(void) {}
+#endif  // RGB_MATRIX_HSV_BATCH
+
+#ifdef RGB_MATRIX_LED_STATE_EFFECTS
+#    define LED_STATE_BITMAP_SIZE ((DRIVER_LED_TOTAL + 7) / 8)
+
+static uint8_t rgb_led_state[DRIVER_LED_TOTAL];
+static uint8_t rgb_led_state_lit[LED_STATE_BITMAP_SIZE];    // LEDs whose state is not 0
+static uint8_t rgb_led_state_dirty[LED_STATE_BITMAP_SIZE];  // LEDs effect_runner_led_state() has to redraw
+static bool    rgb_led_state_drawing;
+
+static inline void rgb_led_state_mark(uint8_t index) { rgb_led_state_dirty[index / 8] |= 1 << (index % 8); }
+
+uint8_t rgb_matrix_led_state_get(uint8_t index) { return index < DRIVER_LED_TOTAL ? rgb_led_state[index] : 0; }
+
+void rgb_matrix_led_state_set(uint8_t index, uint8_t value) {
+    if (index >= DRIVER_LED_TOTAL || rgb_led_state[index] == value) {
+        return;
+    }
+    rgb_led_state[index] = value;
+    if (value) {
+        rgb_led_state_lit[index / 8] |= 1 << (index % 8);
+    } else {
+        rgb_led_state_lit[index / 8] &= ~(1 << (index % 8));
+    }
+    rgb_led_state_mark(index);
+}
+
+void rgb_matrix_led_state_add(uint8_t index, uint8_t amount) {
+    if (index < DRIVER_LED_TOTAL) {
+        rgb_matrix_led_state_set(index, qadd8(rgb_led_state[index], amount));
+    }
+}
+
+void rgb_matrix_led_state_decay(uint8_t amount) {
+    // Only LEDs that are lit need to go down, skip the rest a byte at a time
+    for (uint8_t byte = 0; byte < LED_STATE_BITMAP_SIZE; byte++) {
+        uint8_t lit = rgb_led_state_lit[byte];
+        for (uint8_t index = byte * 8; lit; index++, lit >>= 1) {
+            if (lit & 1) {
+                rgb_matrix_led_state_set(index, qsub8(rgb_led_state[index], amount));
+            }
+        }
+    }
+}
+
+void rgb_matrix_led_state_clear(void) {
+    memset(rgb_led_state, 0, sizeof(rgb_led_state));
+    memset(rgb_led_state_lit, 0, sizeof(rgb_led_state_lit));
+    rgb_matrix_led_state_invalidate();
+}
+
+void rgb_matrix_led_state_invalidate(void) { memset(rgb_led_state_dirty, 0xFF, sizeof(rgb_led_state_dirty)); }
+#endif  // RGB_MATRIX_LED_STATE_EFFECTS
+
 // Generic effect runners
 #include "rgb_matrix_runners/effect_runner_dx_dy_dist.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy.h"
+#include "rgb_matrix_runners/effect_runner_angle.h"
+#include "rgb_matrix_runners/effect_runner_angle_dist.h"
 #include "rgb_matrix_runners/effect_runner_i.h"
 #include "rgb_matrix_runners/effect_runner_sin_cos_i.h"
 #include "rgb_matrix_runners/effect_runner_reactive.h"
 #include "rgb_matrix_runners/effect_runner_reactive_splash.h"
+#include "rgb_matrix_runners/effect_runner_led_state.h"
 
 // ------------------------------------------
 // -----Begin rgb effect includes macros-----
@@ -127,6 +242,9 @@ uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+led_geometry_t g_led_geometry[DRIVER_LED_TOTAL];
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
 
 // internals
 static uint8_t         rgb_last_enable   = UINT8_MAX;
@@ -142,10 +260,40 @@ static uint32_t rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 static last_hit_t last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
-
-void eeconfig_read_rgb_matrix(void) { eeprom_read_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
-
-void eeconfig_update_rgb_matrix(void) { eeprom_update_block(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+#ifdef RGB_MATRIX_DOUBLE_BUFFER
+// Effects render into the back buffer, the driver only sees complete frames
+static RGB rgb_back_buffer[DRIVER_LED_TOTAL];
+#endif  // RGB_MATRIX_DOUBLE_BUFFER
+
+#ifdef RGB_MATRIX_INDICATOR_OVERLAY
+// Laid over the back buffer at flush time, and only rebuilt when what it shows may have changed
+#    define OVERLAY_MASK_SIZE ((DRIVER_LED_TOTAL + 7) / 8)
+
+static RGB     rgb_overlay[DRIVER_LED_TOTAL];
+static uint8_t rgb_overlay_mask[OVERLAY_MASK_SIZE];
+static bool    rgb_overlay_visible;
+static bool    rgb_overlay_stale = true;
+static uint8_t rgb_overlay_host_leds;
+static uint8_t rgb_overlay_mods;
+#    ifndef NO_ACTION_LAYER
+static layer_state_t rgb_overlay_layer_state;
+static layer_state_t rgb_overlay_default_layer_state;
+#    endif  // NO_ACTION_LAYER
+
+static inline bool rgb_overlay_covers(uint8_t index) { return rgb_overlay_mask[index / 8] & (1 << (index % 8)); }
+#endif  // RGB_MATRIX_INDICATOR_OVERLAY
+
+#ifdef RGB_MATRIX_FRAME_STATS
+static rgb_matrix_frame_stats_t rgb_frame_stats;
+static uint32_t                 rgb_frame_render_us;
+static uint32_t                 rgb_frame_start;
+static uint32_t                 rgb_fps_timer;
+static uint16_t                 rgb_fps_count;
+#endif  // RGB_MATRIX_FRAME_STATS
+
+void eeconfig_read_rgb_matrix(void) { eeconfig_read_deferred(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
+
+void eeconfig_update_rgb_matrix(void) { eeconfig_update_deferred(&rgb_matrix_config, EECONFIG_RGB_MATRIX, sizeof(rgb_matrix_config)); }
 
 void eeconfig_update_rgb_matrix_default(void) {
     dprintf("eeconfig_update_rgb_matrix_default\n");
@@ -178,11 +326,109 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+#ifdef RGB_MATRIX_INDICATOR_OVERLAY
+__attribute__((weak)) void rgb_matrix_overlay_kb(void) {}
+
+__attribute__((weak)) void rgb_matrix_overlay_user(void) {}
+
+void rgb_matrix_overlay_set_color(uint8_t index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index < DRIVER_LED_TOTAL) {
+        rgb_overlay[index] = (RGB){.r = red, .g = green, .b = blue};
+        rgb_overlay_mask[index / 8] |= 1 << (index % 8);
+    }
+}
+
+void rgb_matrix_overlay_layer_keys(uint8_t layer, uint8_t red, uint8_t green, uint8_t blue) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t index = g_led_config.matrix_co[row][col];
+            if (index != NO_LED && keymap_key_to_keycode(layer, (keypos_t){.row = row, .col = col}) > KC_TRNS) {
+                rgb_matrix_overlay_set_color(index, red, green, blue);
+            }
+        }
+    }
+}
+
+void rgb_matrix_overlay_invalidate(void) { rgb_overlay_stale = true; }
+
+static void rgb_overlay_update(void) {
+    uint8_t host_leds = host_keyboard_leds();
+    uint8_t mods      = get_mods();
+    if (host_leds != rgb_overlay_host_leds || mods != rgb_overlay_mods) {
+        rgb_overlay_host_leds = host_leds;
+        rgb_overlay_mods      = mods;
+        rgb_overlay_stale     = true;
+    }
+#    ifndef NO_ACTION_LAYER
+    if (layer_state != rgb_overlay_layer_state || default_layer_state != rgb_overlay_default_layer_state) {
+        rgb_overlay_layer_state         = layer_state;
+        rgb_overlay_default_layer_state = default_layer_state;
+        rgb_overlay_stale               = true;
+    }
+#    endif  // NO_ACTION_LAYER
+    if (!rgb_overlay_stale) {
+        return;
+    }
+    rgb_overlay_stale = false;
+
+    memset(rgb_overlay_mask, 0, sizeof(rgb_overlay_mask));
+    rgb_matrix_overlay_kb();
+    rgb_matrix_overlay_user();
+}
+#endif  // RGB_MATRIX_INDICATOR_OVERLAY
+
+#ifdef RGB_MATRIX_DOUBLE_BUFFER
+void rgb_matrix_update_pwm_buffers(void) {
+    // Publish the finished frame in one go, drivers skip registers that did not change
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        RGB color = rgb_back_buffer[i];
+#    ifdef RGB_MATRIX_INDICATOR_OVERLAY
+        if (rgb_overlay_visible && rgb_overlay_covers(i)) {
+            color = rgb_overlay[i];
+        }
+#    endif  // RGB_MATRIX_INDICATOR_OVERLAY
+        rgb_matrix_driver.set_color(i, color.r, color.g, color.b);
+    }
+    rgb_matrix_driver.flush();
+}
+
+static void rgb_matrix_write_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index >= 0 && index < DRIVER_LED_TOTAL) {
+        rgb_back_buffer[index] = (RGB){.r = red, .g = green, .b = blue};
+    }
+}
+
+static void rgb_matrix_write_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        rgb_back_buffer[i] = (RGB){.r = red, .g = green, .b = blue};
+    }
+}
+#else
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
-void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
+static void rgb_matrix_write_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
+
+static void rgb_matrix_write_color_all(uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color_all(red, green, blue); }
+#endif  // RGB_MATRIX_DOUBLE_BUFFER
 
-void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color_all(red, green, blue); }
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_LED_STATE_EFFECTS
+    // LED state effects only redraw what changed, so put back whatever else is drawn over them on the next frame
+    if (!rgb_led_state_drawing && index >= 0 && index < DRIVER_LED_TOTAL) {
+        rgb_led_state_mark(index);
+    }
+#endif  // RGB_MATRIX_LED_STATE_EFFECTS
+    rgb_matrix_write_color(index, red, green, blue);
+}
+
+void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_LED_STATE_EFFECTS
+    if (!rgb_led_state_drawing) {
+        rgb_matrix_led_state_invalidate();
+    }
+#endif  // RGB_MATRIX_LED_STATE_EFFECTS
+    rgb_matrix_write_color_all(red, green, blue);
+}
 
 bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record) {
 #if RGB_DISABLE_TIMEOUT > 0
@@ -299,15 +545,68 @@ static void rgb_task_sync(void) {
     if (timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
 }
 
+#ifdef RGB_MATRIX_FRAME_STATS
+static void rgb_stats_frame_start(void) {
+    uint32_t now = timer_read32();
+#    if RGB_MATRIX_LED_FLUSH_LIMIT > 0
+    // Every whole flush period beyond the first one is a frame we never showed
+    if (rgb_frame_stats.frames > 0) {
+        uint32_t interval = TIMER_DIFF_32(now, rgb_frame_start);
+        if (interval >= 2 * RGB_MATRIX_LED_FLUSH_LIMIT) {
+            rgb_frame_stats.frames_dropped += interval / RGB_MATRIX_LED_FLUSH_LIMIT - 1;
+        }
+    }
+#    endif
+    rgb_frame_start     = now;
+    rgb_frame_render_us = 0;
+}
+
+static void rgb_stats_frame_end(uint32_t flush_us) {
+    rgb_frame_stats.frames++;
+    rgb_frame_stats.render_us = rgb_frame_render_us;
+    rgb_frame_stats.flush_us  = flush_us;
+    if (rgb_frame_render_us > rgb_frame_stats.render_us_max) rgb_frame_stats.render_us_max = rgb_frame_render_us;
+    if (flush_us > rgb_frame_stats.flush_us_max) rgb_frame_stats.flush_us_max = flush_us;
+
+    rgb_fps_count++;
+    if (timer_elapsed32(rgb_fps_timer) >= 1000) {
+        rgb_frame_stats.fps = rgb_fps_count;
+        rgb_fps_count       = 0;
+        rgb_fps_timer       = timer_read32();
+        if (debug_enable) {
+            rgb_matrix_print_frame_stats();
+        }
+    }
+}
+
+const rgb_matrix_frame_stats_t *rgb_matrix_get_frame_stats(void) { return &rgb_frame_stats; }
+
+void rgb_matrix_reset_frame_stats(void) {
+    rgb_frame_stats = (rgb_matrix_frame_stats_t){0};
+    rgb_fps_count   = 0;
+    rgb_fps_timer   = timer_read32();
+}
+
+void rgb_matrix_print_frame_stats(void) {
+    xprintf("rgb_matrix: %u fps, render %luus (max %lu), flush %luus (max %lu), dropped %lu/%lu\n", rgb_frame_stats.fps, rgb_frame_stats.render_us, rgb_frame_stats.render_us_max, rgb_frame_stats.flush_us, rgb_frame_stats.flush_us_max, rgb_frame_stats.frames_dropped, rgb_frame_stats.frames);
+}
+#endif  // RGB_MATRIX_FRAME_STATS
+
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+#ifdef RGB_MATRIX_FRAME_STATS
+    rgb_stats_frame_start();
+#endif  // RGB_MATRIX_FRAME_STATS
 
     // update double buffers
     g_rgb_timer = rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker = last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_INDICATOR_OVERLAY
+    rgb_overlay_update();
+#endif  // RGB_MATRIX_INDICATOR_OVERLAY
 
     // next task
     rgb_task_state = RENDERING;
@@ -374,8 +673,19 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_last_effect = effect;
     rgb_last_enable = rgb_matrix_config.enable;
 
+#ifdef RGB_MATRIX_INDICATOR_OVERLAY
+    // Like the indicators, the overlay stays off while the matrix is
+    rgb_overlay_visible = effect != RGB_MATRIX_NONE;
+#endif  // RGB_MATRIX_INDICATOR_OVERLAY
+
     // update pwm buffers
+#ifdef RGB_MATRIX_FRAME_STATS
+    uint32_t flush_start = timer_read_us();
     rgb_matrix_update_pwm_buffers();
+    rgb_stats_frame_end(timer_elapsed_us(flush_start));
+#else
+    rgb_matrix_update_pwm_buffers();
+#endif  // RGB_MATRIX_FRAME_STATS
 
     // next task
     rgb_task_state = SYNCING;
@@ -401,13 +711,20 @@ void rgb_matrix_task(void) {
         case STARTING:
             rgb_task_start();
             break;
-        case RENDERING:
+        case RENDERING: {
+#ifdef RGB_MATRIX_FRAME_STATS
+            uint32_t render_start = timer_read_us();
+#endif  // RGB_MATRIX_FRAME_STATS
             rgb_task_render(effect);
             if (effect) {
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
+#ifdef RGB_MATRIX_FRAME_STATS
+            rgb_frame_render_us += timer_elapsed_us(render_start);
+#endif  // RGB_MATRIX_FRAME_STATS
             break;
+        }
         case FLUSHING:
             rgb_task_flush(effect);
             break;
@@ -451,6 +768,13 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        g_led_geometry[i].dist  = rgb_matrix_compute_led_dist(i);
+        g_led_geometry[i].angle = rgb_matrix_compute_led_angle(i);
+    }
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
@@ -621,4 +945,9 @@ void rgb_matrix_decrease_speed(void) { rgb_matrix_decrease_speed_helper(true); }
 
 led_flags_t rgb_matrix_get_flags(void) { return rgb_effect_params.flags; }
 
-void rgb_matrix_set_flags(led_flags_t flags) { rgb_effect_params.flags = flags; }
+void rgb_matrix_set_flags(led_flags_t flags) {
+    rgb_effect_params.flags = flags;
+#ifdef RGB_MATRIX_LED_STATE_EFFECTS
+    rgb_matrix_led_state_invalidate();
+#endif  // RGB_MATRIX_LED_STATE_EFFECTS
+}
@@ -56,6 +56,17 @@
         uint8_t max = DRIVER_LED_TOTAL;
 #endif
 
+// The overlay is laid over the effect when the back buffer is published, so
+// the effect's own colors are still there for LEDs the overlay stops covering
+#if defined(RGB_MATRIX_INDICATOR_OVERLAY) && !defined(RGB_MATRIX_DOUBLE_BUFFER)
+#    define RGB_MATRIX_DOUBLE_BUFFER
+#endif
+
+// The typing heatmap keeps its heat per LED
+#if defined(RGB_MATRIX_FRAMEBUFFER_EFFECTS) && !defined(DISABLE_RGB_MATRIX_TYPING_HEATMAP) && !defined(RGB_MATRIX_LED_STATE_EFFECTS)
+#    define RGB_MATRIX_LED_STATE_EFFECTS
+#endif
+
 #define RGB_MATRIX_INDICATOR_SET_COLOR(i, r, g, b) \
     if (i >= led_min && i <= led_max) {            \
         rgb_matrix_set_color(i, r, g, b);          \
@@ -112,8 +123,46 @@ void rgb_matrix_indicators_advanced(effect_params_t *params);
 void rgb_matrix_indicators_advanced_kb(uint8_t led_min, uint8_t led_max);
 void rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max);
 
+#ifdef RGB_MATRIX_INDICATOR_OVERLAY
+/* Colors drawn over the effect when the frame is flushed. The overlay is rebuilt
+ * by calling rgb_matrix_overlay_kb() and rgb_matrix_overlay_user() only when the
+ * layers, mods or host LEDs change, or after rgb_matrix_overlay_invalidate(). */
+void rgb_matrix_overlay_kb(void);
+void rgb_matrix_overlay_user(void);
+void rgb_matrix_overlay_set_color(uint8_t index, uint8_t red, uint8_t green, uint8_t blue);
+void rgb_matrix_overlay_layer_keys(uint8_t layer, uint8_t red, uint8_t green, uint8_t blue);
+void rgb_matrix_overlay_invalidate(void);
+#endif
+
 void rgb_matrix_init(void);
 
+#ifdef RGB_MATRIX_LED_STATE_EFFECTS
+/* Persistent per-LED state for effects that evolve over time. Changing an LED's
+ * state marks it, and effect_runner_led_state() only redraws marked LEDs. */
+uint8_t rgb_matrix_led_state_get(uint8_t index);
+void    rgb_matrix_led_state_set(uint8_t index, uint8_t value);
+void    rgb_matrix_led_state_add(uint8_t index, uint8_t amount);
+void    rgb_matrix_led_state_decay(uint8_t amount);
+void    rgb_matrix_led_state_clear(void);
+void    rgb_matrix_led_state_invalidate(void);
+#endif
+
+#ifdef RGB_MATRIX_FRAME_STATS
+typedef struct {
+    uint32_t frames;
+    uint32_t frames_dropped;  // frames that missed their RGB_MATRIX_LED_FLUSH_LIMIT slot
+    uint32_t render_us;       // last frame, summed over all render iterations
+    uint32_t render_us_max;
+    uint32_t flush_us;
+    uint32_t flush_us_max;
+    uint16_t fps;  // frames completed in the last second
+} rgb_matrix_frame_stats_t;
+
+const rgb_matrix_frame_stats_t *rgb_matrix_get_frame_stats(void);
+void                            rgb_matrix_reset_frame_stats(void);
+void                            rgb_matrix_print_frame_stats(void);
+#endif
+
 void        rgb_matrix_set_suspend_state(bool state);
 bool        rgb_matrix_get_suspend_state(void);
 void        rgb_matrix_toggle(void);
@@ -225,3 +274,6 @@ extern last_hit_t g_last_hit_tracker;
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
 extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
 #endif
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+extern led_geometry_t g_led_geometry[DRIVER_LED_TOTAL];
+#endif
@@ -11,10 +11,10 @@ bool GRADIENT_LEFT_RIGHT(effect_params_t* params) {
         RGB_MATRIX_TEST_LED_FLAGS();
         // The x range will be 0..224, map this to 0..7
         // Relies on hue being 8-bit and wrapping
-        hsv.h   = rgb_matrix_config.hsv.h + (scale * g_led_config.point[i].x >> 5);
-        RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        hsv.h = rgb_matrix_config.hsv.h + (scale * g_led_config.point[i].x >> 5);
+        rgb_matrix_set_hsv(i, hsv);
     }
+    rgb_matrix_flush_hsv();
     return led_max < DRIVER_LED_TOTAL;
 }
 
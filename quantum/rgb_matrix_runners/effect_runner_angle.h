@@ -0,0 +1,15 @@
+#pragma once
+
+typedef HSV (*angle_f)(HSV hsv, uint8_t angle, uint8_t time);
+
+bool effect_runner_angle(effect_params_t* params, angle_f effect_func) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    uint8_t time = scale16by8(g_rgb_timer, rgb_matrix_config.speed / 2);
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        rgb_matrix_set_hsv(i, effect_func(rgb_matrix_config.hsv, rgb_matrix_led_angle(i), time));
+    }
+    rgb_matrix_flush_hsv();
+    return led_max < DRIVER_LED_TOTAL;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifdef RGB_MATRIX_LED_STATE_EFFECTS
+
+typedef HSV (*led_state_f)(HSV hsv, uint8_t state);
+
+// Takes decay_step off every lit LED's state each decay_ms, 0 for no decay
+bool effect_runner_led_state(effect_params_t* params, uint16_t decay_ms, uint8_t decay_step, led_state_f effect_func) {
+    static uint16_t decay_timer;
+    static HSV      last_hsv;
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    if (params->iter == 0) {
+        if (params->init) {
+            rgb_matrix_set_color_all(0, 0, 0);
+            rgb_matrix_led_state_clear();
+            decay_timer = timer_read();
+        }
+        // Every LED's color depends on it
+        if (memcmp(&last_hsv, &rgb_matrix_config.hsv, sizeof(HSV)) != 0) {
+            last_hsv = rgb_matrix_config.hsv;
+            rgb_matrix_led_state_invalidate();
+        }
+        if (decay_ms && timer_elapsed(decay_timer) >= decay_ms) {
+            decay_timer = timer_read();
+            rgb_matrix_led_state_decay(decay_step);
+        }
+    }
+
+    rgb_led_state_drawing = true;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        if (!(rgb_led_state_dirty[i / 8] & (1 << (i % 8)))) continue;
+        rgb_led_state_dirty[i / 8] &= ~(1 << (i % 8));
+        RGB_MATRIX_TEST_LED_FLAGS();
+        rgb_matrix_set_hsv(i, effect_func(rgb_matrix_config.hsv, rgb_led_state[i]));
+    }
+    rgb_matrix_flush_hsv();
+    rgb_led_state_drawing = false;
+    return led_max < DRIVER_LED_TOTAL;
+}
+
+#endif  // RGB_MATRIX_LED_STATE_EFFECTS
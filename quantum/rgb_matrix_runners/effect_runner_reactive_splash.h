@@ -4,6 +4,9 @@
 
 typedef HSV (*reactive_splash_f)(HSV hsv, int16_t dx, int16_t dy, uint8_t dist, uint16_t tick);
 
+// Range of distances a hit tick old can still light up, false once it never will again
+typedef bool (*reactive_splash_reach_f)(uint16_t tick, uint8_t* min_dist, uint8_t* max_dist);
+
 bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, reactive_splash_f effect_func) {
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
@@ -19,11 +22,132 @@ bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, react
             uint16_t tick = scale16by8(g_last_hit_tracker.tick[j], rgb_matrix_config.speed);
             hsv           = effect_func(hsv, dx, dy, dist, tick);
         }
-        hsv.v   = scale8(hsv.v, rgb_matrix_config.hsv.v);
-        RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        hsv.v = scale8(hsv.v, rgb_matrix_config.hsv.v);
+        rgb_matrix_set_hsv(i, hsv);
+    }
+    rgb_matrix_flush_hsv();
+    return led_max < DRIVER_LED_TOTAL;
+}
+
+#    ifdef RGB_MATRIX_SPLASH_GRID
+
+#        ifndef RGB_MATRIX_SPLASH_GRID_COLS
+#            define RGB_MATRIX_SPLASH_GRID_COLS 8
+#        endif
+#        ifndef RGB_MATRIX_SPLASH_GRID_ROWS
+#            define RGB_MATRIX_SPLASH_GRID_ROWS 4
+#        endif
+
+// Cells split the usual 224x64 LED space, the last row and column also take anything
+// beyond them when the grid does not divide it evenly
+#        define SPLASH_GRID_CELL_WIDTH (256 / RGB_MATRIX_SPLASH_GRID_COLS)
+#        define SPLASH_GRID_CELL_HEIGHT (64 / RGB_MATRIX_SPLASH_GRID_ROWS)
+
+#        if LED_HITS_TO_REMEMBER <= 8
+typedef uint8_t splash_hit_mask_t;
+#        elif LED_HITS_TO_REMEMBER <= 16
+typedef uint16_t splash_hit_mask_t;
+#        elif LED_HITS_TO_REMEMBER <= 32
+typedef uint32_t splash_hit_mask_t;
+#        elif LED_HITS_TO_REMEMBER <= 64
+typedef uint64_t splash_hit_mask_t;
+#        else
+#            error "RGB_MATRIX_SPLASH_GRID supports at most 64 LED_HITS_TO_REMEMBER"
+#        endif
+
+static splash_hit_mask_t splash_grid[RGB_MATRIX_SPLASH_GRID_ROWS][RGB_MATRIX_SPLASH_GRID_COLS];
+static uint16_t          splash_grid_tick[LED_HITS_TO_REMEMBER];
+static uint8_t           splash_grid_start;
+
+static uint16_t splash_grid_near_sq(uint8_t hit, uint8_t low, uint8_t high) {
+    uint8_t d = hit < low ? low - hit : hit > high ? hit - high : 0;
+    return (uint16_t)d * d;
+}
+
+static uint16_t splash_grid_far_sq(uint8_t hit, uint8_t low, uint8_t high) {
+    uint8_t to_low  = hit > low ? hit - low : low - hit;
+    uint8_t to_high = hit > high ? hit - high : high - hit;
+    uint8_t d       = to_low > to_high ? to_low : to_high;
+    return (uint16_t)d * d;
+}
+
+// Marks every cell a hit can reach this frame, so LEDs only look at hits that can light them up
+static void splash_grid_build(uint8_t start, reactive_splash_reach_f reach_func) {
+    memset(splash_grid, 0, sizeof(splash_grid));
+    splash_grid_start = g_last_hit_tracker.count;
+    for (uint8_t j = g_last_hit_tracker.count; j-- > start;) {
+        uint16_t tick = scale16by8(g_last_hit_tracker.tick[j], rgb_matrix_config.speed);
+        uint8_t  min_dist, max_dist;
+        // Hits are in the order they happened, once one is spent so are all older ones
+        if (!reach_func(tick, &min_dist, &max_dist)) break;
+        splash_grid_tick[j] = tick;
+        splash_grid_start   = j;
+
+        uint32_t min_sq = (uint32_t)min_dist * min_dist;
+        uint32_t max_sq = (uint32_t)(max_dist + 1) * (max_dist + 1);
+        uint8_t  x      = g_last_hit_tracker.x[j];
+        uint8_t  y      = g_last_hit_tracker.y[j];
+        for (uint8_t row = 0; row < RGB_MATRIX_SPLASH_GRID_ROWS; row++) {
+            uint8_t  top      = row * SPLASH_GRID_CELL_HEIGHT;
+            uint8_t  bottom   = row == RGB_MATRIX_SPLASH_GRID_ROWS - 1 ? UINT8_MAX : top + SPLASH_GRID_CELL_HEIGHT - 1;
+            uint16_t near_dy2 = splash_grid_near_sq(y, top, bottom);
+            uint16_t far_dy2  = splash_grid_far_sq(y, top, bottom);
+            for (uint8_t col = 0; col < RGB_MATRIX_SPLASH_GRID_COLS; col++) {
+                uint8_t left  = col * SPLASH_GRID_CELL_WIDTH;
+                uint8_t right = col == RGB_MATRIX_SPLASH_GRID_COLS - 1 ? UINT8_MAX : left + SPLASH_GRID_CELL_WIDTH - 1;
+                if ((uint32_t)splash_grid_near_sq(x, left, right) + near_dy2 < max_sq && (uint32_t)splash_grid_far_sq(x, left, right) + far_dy2 >= min_sq) {
+                    splash_grid[row][col] |= (splash_hit_mask_t)1 << j;
+                }
+            }
+        }
+    }
+}
+
+// miss_hue is what effect_func adds to the hue for a hit that can't reach the LED, so
+// skipping those hits leaves the hue as it would have been
+bool effect_runner_reactive_splash_reach(uint8_t start, effect_params_t* params, reactive_splash_f effect_func, reactive_splash_reach_f reach_func, uint8_t miss_hue) {
+    RGB_MATRIX_USE_LIMITS(led_min, led_max);
+
+    if (params->iter == 0) {
+        splash_grid_build(start, reach_func);
+    }
+
+    uint8_t count = g_last_hit_tracker.count;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        RGB_MATRIX_TEST_LED_FLAGS();
+        HSV     hsv = rgb_matrix_config.hsv;
+        hsv.v       = 0;
+        uint8_t row = g_led_config.point[i].y / SPLASH_GRID_CELL_HEIGHT;
+        if (row >= RGB_MATRIX_SPLASH_GRID_ROWS) row = RGB_MATRIX_SPLASH_GRID_ROWS - 1;
+        uint8_t col = g_led_config.point[i].x / SPLASH_GRID_CELL_WIDTH;
+        if (col >= RGB_MATRIX_SPLASH_GRID_COLS) col = RGB_MATRIX_SPLASH_GRID_COLS - 1;
+        if (start < count) {
+            uint8_t           newest = count - 1;
+            uint8_t           misses = newest - start;
+            splash_hit_mask_t hits   = splash_grid_start < newest ? splash_grid[row][col] >> splash_grid_start : 0;
+            for (uint8_t j = splash_grid_start; hits && j < newest; j++, hits >>= 1) {
+                if (!(hits & 1)) continue;
+                int16_t dx   = g_led_config.point[i].x - g_last_hit_tracker.x[j];
+                int16_t dy   = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+                uint8_t dist = sqrt16(dx * dx + dy * dy);
+                hsv          = effect_func(hsv, dx, dy, dist, splash_grid_tick[j]);
+                misses--;
+            }
+            // The newest hit always goes last, effects like nexus take their hue from it
+            int16_t dx   = g_led_config.point[i].x - g_last_hit_tracker.x[newest];
+            int16_t dy   = g_led_config.point[i].y - g_last_hit_tracker.y[newest];
+            uint8_t dist = sqrt16(dx * dx + dy * dy);
+            hsv          = effect_func(hsv, dx, dy, dist, scale16by8(g_last_hit_tracker.tick[newest], rgb_matrix_config.speed));
+            hsv.h += misses * miss_hue;
+        }
+        hsv.v = scale8(hsv.v, rgb_matrix_config.hsv.v);
+        rgb_matrix_set_hsv(i, hsv);
     }
+    rgb_matrix_flush_hsv();
     return led_max < DRIVER_LED_TOTAL;
 }
+#    else
+bool effect_runner_reactive_splash_reach(uint8_t start, effect_params_t* params, reactive_splash_f effect_func, reactive_splash_reach_f reach_func, uint8_t miss_hue) { return effect_runner_reactive_splash(start, params, effect_func); }
+#    endif  // RGB_MATRIX_SPLASH_GRID
 
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -48,6 +48,13 @@ typedef struct PACKED {
     uint8_t y;
 } point_t;
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+typedef struct PACKED {
+    uint8_t dist;   // sqrt16(dx * dx + dy * dy) from k_rgb_matrix_center
+    uint8_t angle;  // atan2_8(dy, dx) around k_rgb_matrix_center
+} led_geometry_t;
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
+
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 #define HAS_ANY_FLAGS(bits, flags) ((bits & flags) != 0x00)
 
@@ -23,6 +23,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "split_util.h"
 #include "config.h"
 #include "transport.h"
+#ifdef SPLIT_EVENT_TIMESTAMPS
+#    include "split_events.h"
+#endif
 
 #define ERROR_DISCONNECT_COUNT 5
 
@@ -90,6 +93,24 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     return false;
 }
 
+#    ifdef MATRIX_SCAN_INTERRUPT
+void matrix_idle_enter(void) {}
+
+void matrix_idle_exit(void) {}
+
+bool matrix_idle_probe(void) {
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            pin_t pin = direct_pins[row][col];
+            if (pin != NO_PIN && !readPin(pin)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+#    endif
+
 #elif defined(DIODE_DIRECTION)
 #    if (DIODE_DIRECTION == COL2ROW)
 
@@ -138,6 +159,25 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     return false;
 }
 
+#        ifdef MATRIX_SCAN_INTERRUPT
+void matrix_idle_enter(void) {
+    for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
+        select_row(x);
+    }
+}
+
+void matrix_idle_exit(void) { unselect_rows(); }
+
+bool matrix_idle_probe(void) {
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        if (!readPin(col_pins[x])) {
+            return true;
+        }
+    }
+    return false;
+}
+#        endif
+
 #    elif (DIODE_DIRECTION == ROW2COL)
 
 static void select_col(uint8_t col) { setPinOutput_writeLow(col_pins[col]); }
@@ -192,6 +232,25 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
     return matrix_changed;
 }
 
+#        ifdef MATRIX_SCAN_INTERRUPT
+void matrix_idle_enter(void) {
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+}
+
+void matrix_idle_exit(void) { unselect_cols(); }
+
+bool matrix_idle_probe(void) {
+    for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
+        if (!readPin(row_pins[x])) {
+            return true;
+        }
+    }
+    return false;
+}
+#        endif
+
 #    else
 #        error DIODE_DIRECTION must be one of COL2ROW or ROW2COL!
 #    endif
@@ -199,6 +258,57 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#if defined(MATRIX_SCAN_INTERRUPT) && defined(PROTOCOL_CHIBIOS) && (PAL_USE_CALLBACKS == TRUE)
+static BSEMAPHORE_DECL(matrix_wakeup_sem, true);
+
+static void matrix_wakeup_callback(void *arg) {
+    matrix_wakeup_signal();
+    chSysLockFromISR();
+    chBSemSignalI(&matrix_wakeup_sem);
+    chSysUnlockFromISR();
+}
+
+static void set_wakeup_line(pin_t pin, bool enable) {
+    if (enable) {
+        palEnableLineEvent(pin, PAL_EVENT_MODE_FALLING_EDGE);
+        palSetLineCallback(pin, matrix_wakeup_callback, NULL);
+    } else {
+        palDisableLineEvent(pin);
+    }
+}
+
+static void set_wakeup_lines(bool enable) {
+#    ifdef DIRECT_PINS
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (direct_pins[row][col] != NO_PIN) {
+                set_wakeup_line(direct_pins[row][col], enable);
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        set_wakeup_line(col_pins[x], enable);
+    }
+#    else
+    for (uint8_t x = 0; x < ROWS_PER_HAND; x++) {
+        set_wakeup_line(row_pins[x], enable);
+    }
+#    endif
+}
+
+bool matrix_wakeup_arm(void) {
+    set_wakeup_lines(true);
+    return true;
+}
+
+void matrix_wakeup_disarm(void) { set_wakeup_lines(false); }
+
+/* Sleeps until a line event or for at most 1ms, so timers, animations,
+ * EEPROM flushes and the split transport keep running while idle */
+void matrix_wakeup_wait(void) { chBSemWaitTimeout(&matrix_wakeup_sem, TIME_MS2I(1)); }
+#endif
+
 void matrix_init(void) {
     split_pre_init();
 
@@ -270,9 +380,26 @@ void matrix_post_scan(void) {
     }
 }
 
+#ifdef SPLIT_EVENT_TIMESTAMPS
+uint16_t matrix_event_time(uint8_t row, uint8_t col) {
+    // Changes on the other half happened some time before the transport brought them here
+    if (is_keyboard_master() && row >= thatHand && row < thatHand + ROWS_PER_HAND) {
+        return split_events_time(row - thatHand, col);
+    }
+    return timer_read();
+}
+#endif
+
 uint8_t matrix_scan(void) {
     bool changed = false;
 
+#ifdef MATRIX_SCAN_INTERRUPT
+    if (!matrix_wakeup_poll()) {
+        matrix_post_scan();
+        return 0;
+    }
+#endif
+
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
@@ -287,6 +414,10 @@ uint8_t matrix_scan(void) {
 
     debounce(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
 
+#ifdef MATRIX_SCAN_INTERRUPT
+    matrix_wakeup_update(raw_matrix, matrix + thisHand, ROWS_PER_HAND, changed);
+#endif
+
     matrix_post_scan();
     return (uint8_t)changed;
 }
@@ -1,3 +1,8 @@
+// Key changes the slave reports with their age, see SPLIT_EVENT_TIMESTAMPS
+#if defined(SPLIT_EVENT_TIMESTAMPS) && !defined(SPLIT_EVENT_COUNT)
+#    define SPLIT_EVENT_COUNT 4
+#endif
+
 #if defined(USE_I2C)
 // When using I2C, using rgblight implicitly involves split support.
 #    if defined(RGBLIGHT_ENABLE) && !defined(RGBLIGHT_SPLIT)
@@ -8,6 +13,24 @@
 #        define F_SCL 100000UL  // SCL frequency
 #    endif
 
+// Room for the shared object mailboxes and key ages on top of the usual slave registers
+#    if (defined(SPLIT_TRANSPORT_OBJECTS) || defined(SPLIT_EVENT_TIMESTAMPS)) && !defined(I2C_SLAVE_REG_COUNT)
+#        ifdef SPLIT_TRANSPORT_OBJECTS
+#            ifndef SPLIT_OBJECTS_BUDGET
+#                define SPLIT_OBJECTS_BUDGET 16
+#            endif
+#            define I2C_OBJECTS_REG_COUNT (2 * SPLIT_OBJECTS_BUDGET)
+#        else
+#            define I2C_OBJECTS_REG_COUNT 0
+#        endif
+#        ifdef SPLIT_EVENT_TIMESTAMPS
+#            define I2C_EVENTS_REG_COUNT (2 * SPLIT_EVENT_COUNT)
+#        else
+#            define I2C_EVENTS_REG_COUNT 0
+#        endif
+#        define I2C_SLAVE_REG_COUNT (30 + I2C_OBJECTS_REG_COUNT + I2C_EVENTS_REG_COUNT)
+#    endif
+
 #else  // use serial
 // When using serial, the user must define RGBLIGHT_SPLIT explicitly
 //  in config.h as needed.
@@ -16,4 +39,9 @@
 // When using serial and RGBLIGHT_SPLIT need separate transaction
 #        define SERIAL_USE_MULTI_TRANSACTION
 #    endif
+// The delta protocol probes the slave's status before fetching its matrix,
+// and shared objects have a transaction of their own
+#    if (defined(SPLIT_TRANSPORT_DELTA) || defined(SPLIT_TRANSPORT_OBJECTS)) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
 #endif
@@ -0,0 +1,84 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "split_events.h"
+#include <string.h>
+#include "timer.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+#if defined(SPLIT_EVENT_TIMESTAMPS) && ROWS_PER_HAND * MATRIX_COLS >= SPLIT_EVENT_NONE
+#    error SPLIT_EVENT_TIMESTAMPS supports up to 254 keys per half
+#endif
+
+typedef struct {
+    uint8_t  key;
+    uint16_t time;
+} split_key_event_t;
+
+static matrix_row_t      slave_event_matrix[ROWS_PER_HAND];
+static split_key_event_t key_events[SPLIT_EVENT_COUNT];  // newest first
+
+void split_events_init(void) {
+    for (uint8_t i = 0; i < SPLIT_EVENT_COUNT; i++) {
+        key_events[i].key = SPLIT_EVENT_NONE;
+    }
+}
+
+void split_events_record(const matrix_row_t matrix[]) {
+    uint16_t now = timer_read();
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t changes = matrix[row] ^ slave_event_matrix[row];
+        for (uint8_t col = 0; changes && col < MATRIX_COLS; col++) {
+            if (changes & ((matrix_row_t)1 << col)) {
+                memmove(&key_events[1], &key_events[0], sizeof(key_events) - sizeof(key_events[0]));
+                key_events[0].key  = row * MATRIX_COLS + col;
+                key_events[0].time = now;
+            }
+        }
+        slave_event_matrix[row] = matrix[row];
+    }
+}
+
+void split_events_publish(split_key_age_t *ages) {
+    for (uint8_t i = 0; i < SPLIT_EVENT_COUNT; i++) {
+        uint16_t age = timer_elapsed(key_events[i].time);
+        if (age > SPLIT_EVENT_MAX_AGE) {
+            key_events[i].key = SPLIT_EVENT_NONE;
+        }
+        ages[i].key = key_events[i].key;
+        ages[i].age = age;
+    }
+}
+
+void split_events_receive(const split_key_age_t *ages) {
+    uint16_t now = timer_read();
+    for (uint8_t i = 0; i < SPLIT_EVENT_COUNT; i++) {
+        key_events[i].key  = ages[i].key;
+        key_events[i].time = now - ages[i].age;
+    }
+}
+
+uint16_t split_events_time(uint8_t row, uint8_t col) {
+    uint8_t key = row * MATRIX_COLS + col;
+    for (uint8_t i = 0; i < SPLIT_EVENT_COUNT; i++) {
+        if (key_events[i].key == key) {
+            return key_events[i].time;
+        }
+    }
+    return timer_read();
+}
@@ -0,0 +1,51 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Key change times for SPLIT_EVENT_TIMESTAMPS.
+ *
+ * The slave remembers its last SPLIT_EVENT_COUNT key changes and reports each
+ * with its age, from which the master works out when the change happened on
+ * its own clock. Keys are numbered row * MATRIX_COLS + col within the half.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "matrix.h"
+
+#ifndef SPLIT_EVENT_COUNT
+#    define SPLIT_EVENT_COUNT 4
+#endif
+
+#define SPLIT_EVENT_NONE 0xFF
+#define SPLIT_EVENT_MAX_AGE UINT8_MAX  // older changes are forgotten
+
+typedef struct {
+    uint8_t key;
+    uint8_t age;  // ms
+} split_key_age_t;
+
+void split_events_init(void);
+
+// Slave side: note the changes since the last call, then report their ages
+void split_events_record(const matrix_row_t matrix[]);
+void split_events_publish(split_key_age_t *ages);
+
+// Master side: take in the reported ages
+void split_events_receive(const split_key_age_t *ages);
+
+// when the slave saw the key at row, col of its half change, in master time
+uint16_t split_events_time(uint8_t row, uint8_t col);
@@ -0,0 +1,201 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "split_objects.h"
+#include <string.h>
+#include "timer.h"
+
+#define SPLIT_OBJECT_DIRTY (1 << 0)
+#define SPLIT_OBJECT_IN_FLIGHT (1 << 1)
+#define SPLIT_OBJECT_UPDATED (1 << 2)
+
+/* Mailbox layout:
+ *   [0] sequence number of the records, 0 when there are none
+ *   [1] sequence number of the last mailbox received from the other half
+ *   [2] checksum of everything else
+ *   [3] records, each an object id followed by the object, up to SPLIT_OBJECTS_END
+ */
+#define MAILBOX_SEQUENCE 0
+#define MAILBOX_ACKNOWLEDGE 1
+#define MAILBOX_CHECKSUM 2
+#define MAILBOX_RECORDS SPLIT_OBJECTS_HEADER
+
+split_registry_t split_registry;
+
+// CRC-8, polynomial 0x07, catches mailboxes torn by a concurrent update
+static uint8_t mailbox_checksum(const uint8_t *mailbox) {
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < SPLIT_OBJECTS_BUDGET; i++) {
+        if (i == MAILBOX_CHECKSUM) {
+            continue;
+        }
+        crc ^= mailbox[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+void split_registry_init(split_registry_t *registry) { memset(registry, 0, sizeof(*registry)); }
+
+bool split_registry_add(split_registry_t *registry, split_object_t **objects, uint8_t count) {
+    if (registry->count + count > SPLIT_OBJECTS_MAX) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (objects[i]->size + 1 > SPLIT_OBJECTS_PAYLOAD) {
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        // Whatever the object starts out as is sent once, so both halves agree
+        objects[i]->flags                    = SPLIT_OBJECT_DIRTY;
+        registry->objects[registry->count++] = objects[i];
+    }
+    return true;
+}
+
+bool split_objects_register(split_object_t **objects, uint8_t count) { return split_registry_add(&split_registry, objects, count); }
+
+bool split_object_write(split_object_t *object, const void *data) {
+    if (memcmp(object->data, data, object->size) == 0) {
+        return false;
+    }
+
+    memcpy(object->data, data, object->size);
+    // Whatever is in flight is stale now, it must not be acknowledged as this
+    object->flags &= ~SPLIT_OBJECT_IN_FLIGHT;
+    if (object->policy == SPLIT_SYNC_ON_CHANGE) {
+        object->flags |= SPLIT_OBJECT_DIRTY;
+    }
+    return true;
+}
+
+void split_object_request(split_object_t *object) { object->flags = (object->flags & ~SPLIT_OBJECT_IN_FLIGHT) | SPLIT_OBJECT_DIRTY; }
+
+bool split_object_updated(split_object_t *object) {
+    bool updated = object->flags & SPLIT_OBJECT_UPDATED;
+    object->flags &= ~SPLIT_OBJECT_UPDATED;
+    return updated;
+}
+
+static void fill_records(split_registry_t *registry, uint8_t direction) {
+    uint8_t *records = registry->tx_records;
+    uint16_t now     = timer_read();
+    uint8_t  used    = 0;
+
+    memset(records, SPLIT_OBJECTS_END, SPLIT_OBJECTS_PAYLOAD);
+    for (uint8_t i = 0; i < registry->count; i++) {
+        uint8_t         index  = (registry->cursor + i) % registry->count;
+        split_object_t *object = registry->objects[index];
+        if (object->direction != direction) {
+            continue;
+        }
+        if (object->policy == SPLIT_SYNC_PERIODIC && timer_elapsed(object->last_sent) >= object->period) {
+            object->flags |= SPLIT_OBJECT_DIRTY;
+        }
+        // Objects that don't fit wait for the next mailbox, smaller ones may still go in this one
+        if (!(object->flags & SPLIT_OBJECT_DIRTY) || used + 1 + object->size > SPLIT_OBJECTS_PAYLOAD) {
+            continue;
+        }
+
+        records[used++] = index;
+        memcpy(&records[used], object->data, object->size);
+        used += object->size;
+
+        object->flags     = (object->flags & ~SPLIT_OBJECT_DIRTY) | SPLIT_OBJECT_IN_FLIGHT;
+        object->last_sent = now;
+        registry->cursor  = (index + 1) % registry->count;
+    }
+
+    if (used) {
+        registry->tx_last     = registry->tx_last == UINT8_MAX ? 1 : registry->tx_last + 1;
+        registry->tx_sequence = registry->tx_last;
+    }
+}
+
+void split_registry_pack(split_registry_t *registry, uint8_t *mailbox, uint8_t direction) {
+    // The pending records are sent again until they are acknowledged
+    if (!registry->tx_sequence) {
+        fill_records(registry, direction);
+    }
+
+    mailbox[MAILBOX_SEQUENCE]    = registry->tx_sequence;
+    mailbox[MAILBOX_ACKNOWLEDGE] = registry->rx_sequence;
+    if (registry->tx_sequence) {
+        memcpy(&mailbox[MAILBOX_RECORDS], registry->tx_records, SPLIT_OBJECTS_PAYLOAD);
+    } else {
+        memset(&mailbox[MAILBOX_RECORDS], SPLIT_OBJECTS_END, SPLIT_OBJECTS_PAYLOAD);
+    }
+    mailbox[MAILBOX_CHECKSUM] = mailbox_checksum(mailbox);
+}
+
+static void acknowledge(split_registry_t *registry, uint8_t acknowledged, uint8_t direction) {
+    if (acknowledged == 0) {
+        if (registry->peer_synced) {
+            // The other half restarted, everything it had from us is gone
+            for (uint8_t i = 0; i < registry->count; i++) {
+                split_object_t *object = registry->objects[i];
+                if (object->direction == direction) {
+                    object->flags = (object->flags & ~SPLIT_OBJECT_IN_FLIGHT) | SPLIT_OBJECT_DIRTY;
+                }
+            }
+            registry->tx_sequence = 0;
+            registry->peer_synced = false;
+        }
+        // Nor does it know our sequence numbers, accept the next one whatever it is
+        registry->rx_sequence = 0;
+        return;
+    }
+
+    registry->peer_synced = true;
+    if (registry->tx_sequence && acknowledged == registry->tx_sequence) {
+        for (uint8_t i = 0; i < registry->count; i++) {
+            registry->objects[i]->flags &= ~SPLIT_OBJECT_IN_FLIGHT;
+        }
+        registry->tx_sequence = 0;
+    }
+}
+
+void split_registry_unpack(split_registry_t *registry, const uint8_t *mailbox, uint8_t direction) {
+    if (mailbox[MAILBOX_CHECKSUM] != mailbox_checksum(mailbox)) {
+        return;
+    }
+
+    // Acknowledges refer to the objects going the other way
+    acknowledge(registry, mailbox[MAILBOX_ACKNOWLEDGE], direction == SPLIT_MASTER_TO_SLAVE ? SPLIT_SLAVE_TO_MASTER : SPLIT_MASTER_TO_SLAVE);
+
+    uint8_t sequence = mailbox[MAILBOX_SEQUENCE];
+    if (!sequence || sequence == registry->rx_sequence) {
+        return;
+    }
+    registry->rx_sequence = sequence;
+
+    const uint8_t *records = &mailbox[MAILBOX_RECORDS];
+    for (uint8_t i = 0; i < SPLIT_OBJECTS_PAYLOAD && records[i] < registry->count;) {
+        split_object_t *object = registry->objects[records[i]];
+        if (object->direction != direction || i + 1 + object->size > SPLIT_OBJECTS_PAYLOAD) {
+            break;  // the halves disagree on what was registered
+        }
+        if (memcmp(object->data, &records[i + 1], object->size) != 0) {
+            memcpy(object->data, &records[i + 1], object->size);
+            object->flags |= SPLIT_OBJECT_UPDATED;
+        }
+        i += 1 + object->size;
+    }
+}
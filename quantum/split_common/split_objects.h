@@ -0,0 +1,103 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Shared objects between the two halves of a split keyboard.
+ *
+ * Keymaps and keyboards declare typed objects with SPLIT_OBJECT(), register
+ * them in the same order on both halves, write them on the sending side and
+ * read split_data_<name> on the other. Each scan the transport exchanges one
+ * mailbox of SPLIT_OBJECTS_BUDGET bytes per direction, filled only with the
+ * objects that are due:
+ *
+ *   SPLIT_SYNC_ON_CHANGE  sent whenever a write changes the object
+ *   SPLIT_SYNC_PERIODIC   sent every period ms whether it changed or not
+ *   SPLIT_SYNC_ON_DEMAND  sent only after split_object_request()
+ *
+ * A mailbox is resent on every exchange until the other half acknowledges its
+ * sequence number, so objects survive dropped or corrupted transfers, and
+ * everything is sent again when the other half restarts.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SPLIT_OBJECTS_MAX
+#    define SPLIT_OBJECTS_MAX 8
+#endif
+
+// Size of the mailbox exchanged in each direction every scan
+#ifndef SPLIT_OBJECTS_BUDGET
+#    define SPLIT_OBJECTS_BUDGET 16
+#endif
+
+#define SPLIT_OBJECTS_HEADER 3  // sequence, acknowledge and checksum
+#define SPLIT_OBJECTS_PAYLOAD (SPLIT_OBJECTS_BUDGET - SPLIT_OBJECTS_HEADER)
+#define SPLIT_OBJECTS_END 0xFF
+
+typedef enum {
+    SPLIT_MASTER_TO_SLAVE,
+    SPLIT_SLAVE_TO_MASTER,
+} split_object_direction_t;
+
+typedef enum {
+    SPLIT_SYNC_ON_CHANGE,
+    SPLIT_SYNC_PERIODIC,
+    SPLIT_SYNC_ON_DEMAND,
+} split_object_policy_t;
+
+typedef struct {
+    void *   data;
+    uint8_t  size;
+    uint8_t  direction;
+    uint8_t  policy;
+    uint16_t period;
+
+    uint8_t  flags;
+    uint16_t last_sent;
+} split_object_t;
+
+typedef struct {
+    split_object_t *objects[SPLIT_OBJECTS_MAX];
+    uint8_t         count;
+    uint8_t         cursor;  // where the next mailbox starts filling, so no object starves
+
+    uint8_t tx_sequence;  // mailbox waiting to be acknowledged, 0 when none
+    uint8_t tx_last;
+    uint8_t tx_records[SPLIT_OBJECTS_PAYLOAD];
+    uint8_t rx_sequence;  // last mailbox applied, echoed back as the acknowledge
+    bool    peer_synced;
+} split_registry_t;
+
+#define SPLIT_OBJECT(name, type, dir, sync, ms) \
+    type           split_data_##name;           \
+    split_object_t split_object_##name = {.data = &split_data_##name, .size = sizeof(type), .direction = (dir), .policy = (sync), .period = (ms)}
+
+#define SPLIT_OBJECT_PTR(name) (&split_object_##name)
+
+extern split_registry_t split_registry;
+
+bool split_objects_register(split_object_t **objects, uint8_t count);
+
+bool split_object_write(split_object_t *object, const void *data);
+void split_object_request(split_object_t *object);
+bool split_object_updated(split_object_t *object);
+
+// Used by the transport, and by tests with a registry per half
+void split_registry_init(split_registry_t *registry);
+bool split_registry_add(split_registry_t *registry, split_object_t **objects, uint8_t count);
+void split_registry_pack(split_registry_t *registry, uint8_t *mailbox, uint8_t direction);
+void split_registry_unpack(split_registry_t *registry, const uint8_t *mailbox, uint8_t direction);
@@ -0,0 +1,6 @@
+split_objects_INC := $(QUANTUM_PATH)/split_common
+
+split_objects_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_objects_tests.cpp \
+	$(QUANTUM_PATH)/split_common/split_objects.c \
+	$(TMK_PATH)/common/test/timer.c
@@ -0,0 +1,239 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "split_objects.h"
+#include "timer.h"
+
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+typedef struct {
+    uint8_t  mods;
+    uint32_t layers;
+} keymap_state_t;
+
+// Each half gets its own copy of the same objects, registered in the same order
+struct half_t {
+    split_registry_t registry;
+
+    keymap_state_t   keymap         = {};
+    uint8_t          battery        = 0;
+    uint16_t         clock          = 0;
+    uint8_t          screen[8]      = {};
+    split_object_t   keymap_object  = {&keymap, sizeof(keymap), SPLIT_MASTER_TO_SLAVE, SPLIT_SYNC_ON_CHANGE, 0};
+    split_object_t   battery_object = {&battery, sizeof(battery), SPLIT_SLAVE_TO_MASTER, SPLIT_SYNC_ON_CHANGE, 0};
+    split_object_t   clock_object   = {&clock, sizeof(clock), SPLIT_MASTER_TO_SLAVE, SPLIT_SYNC_PERIODIC, 500};
+    split_object_t   screen_object  = {screen, sizeof(screen), SPLIT_MASTER_TO_SLAVE, SPLIT_SYNC_ON_DEMAND, 0};
+    split_object_t * objects[4]     = {&keymap_object, &battery_object, &clock_object, &screen_object};
+
+    void init() {
+        split_registry_init(&registry);
+        EXPECT_TRUE(split_registry_add(&registry, objects, 4));
+    }
+};
+
+class SplitObjectsTest : public ::testing::Test {
+   protected:
+    half_t  master;
+    half_t  slave;
+    uint8_t m2s[SPLIT_OBJECTS_BUDGET];
+    uint8_t s2m[SPLIT_OBJECTS_BUDGET];
+
+    void SetUp() override {
+        set_time(1000);
+        memset(m2s, 0, sizeof(m2s));
+        memset(s2m, 0, sizeof(s2m));
+        master.init();
+        slave.init();
+    }
+
+    // One scan: the master's transaction carries both mailboxes, the slave
+    // handles its side afterwards, so its answer goes out on the next scan
+    void exchange(bool deliver_m2s = true, bool deliver_s2m = true) {
+        split_registry_pack(&master.registry, m2s, SPLIT_MASTER_TO_SLAVE);
+        if (deliver_s2m) {
+            split_registry_unpack(&master.registry, s2m, SPLIT_SLAVE_TO_MASTER);
+        }
+        if (deliver_m2s) {
+            split_registry_unpack(&slave.registry, m2s, SPLIT_MASTER_TO_SLAVE);
+        }
+        split_registry_pack(&slave.registry, s2m, SPLIT_SLAVE_TO_MASTER);
+        advance_time(1);
+    }
+
+    void settle() {
+        for (int i = 0; i < 8; i++) {
+            exchange();
+        }
+        split_object_updated(&master.battery_object);
+        split_object_updated(&slave.keymap_object);
+        split_object_updated(&slave.clock_object);
+    }
+};
+
+TEST_F(SplitObjectsTest, TestChangesReachTheOtherHalf) {
+    settle();
+
+    keymap_state_t state = {.mods = 0x02, .layers = 0x05};
+    EXPECT_TRUE(split_object_write(&master.keymap_object, &state));
+    uint8_t battery = 87;
+    EXPECT_TRUE(split_object_write(&slave.battery_object, &battery));
+    exchange();
+    exchange();
+
+    EXPECT_EQ(slave.keymap.mods, 0x02);
+    EXPECT_EQ(slave.keymap.layers, 0x05u);
+    EXPECT_TRUE(split_object_updated(&slave.keymap_object));
+    EXPECT_FALSE(split_object_updated(&slave.keymap_object));
+    EXPECT_EQ(master.battery, 87);
+    EXPECT_TRUE(split_object_updated(&master.battery_object));
+}
+
+TEST_F(SplitObjectsTest, TestIdleMailboxIsEmpty) {
+    settle();
+
+    keymap_state_t state = master.keymap;
+    EXPECT_FALSE(split_object_write(&master.keymap_object, &state));
+    exchange();
+    EXPECT_EQ(m2s[0], 0);  // no sequence number, nothing to apply
+    EXPECT_EQ(m2s[SPLIT_OBJECTS_HEADER], SPLIT_OBJECTS_END);
+}
+
+TEST_F(SplitObjectsTest, TestLostMailboxIsResent) {
+    settle();
+
+    keymap_state_t state = {.mods = 0x10, .layers = 0};
+    split_object_write(&master.keymap_object, &state);
+    exchange(false);
+    uint8_t sequence = m2s[0];
+    EXPECT_NE(sequence, 0);
+    EXPECT_EQ(slave.keymap.mods, 0);
+
+    // Not acknowledged, so the same mailbox goes out again
+    exchange();
+    EXPECT_EQ(m2s[0], sequence);
+    EXPECT_EQ(slave.keymap.mods, 0x10);
+}
+
+TEST_F(SplitObjectsTest, TestStaleInFlightDataIsNotAcknowledged) {
+    settle();
+
+    keymap_state_t first = {.mods = 0x01, .layers = 0};
+    split_object_write(&master.keymap_object, &first);
+    exchange();
+
+    // Changed again before the first value was acknowledged
+    keymap_state_t second = {.mods = 0x04, .layers = 0};
+    split_object_write(&master.keymap_object, &second);
+    for (int i = 0; i < 4; i++) {
+        exchange();
+    }
+    EXPECT_EQ(slave.keymap.mods, 0x04);
+}
+
+TEST_F(SplitObjectsTest, TestCorruptMailboxIsIgnored) {
+    settle();
+
+    keymap_state_t state = {.mods = 0x20, .layers = 0};
+    split_object_write(&master.keymap_object, &state);
+    split_registry_pack(&master.registry, m2s, SPLIT_MASTER_TO_SLAVE);
+    m2s[SPLIT_OBJECTS_HEADER + 1] ^= 0x01;
+    split_registry_unpack(&slave.registry, m2s, SPLIT_MASTER_TO_SLAVE);
+    EXPECT_EQ(slave.keymap.mods, 0);
+
+    exchange();
+    EXPECT_EQ(slave.keymap.mods, 0x20);
+}
+
+TEST_F(SplitObjectsTest, TestBudgetIsShared) {
+    settle();
+
+    // Both don't fit in one mailbox, the second waits for the next one
+    keymap_state_t state = {.mods = 0x01, .layers = 0x01};
+    split_object_write(&master.keymap_object, &state);
+    memset(master.screen, 0xAA, sizeof(master.screen));
+    split_object_request(&master.screen_object);
+    ASSERT_GT(sizeof(keymap_state_t) + sizeof(master.screen) + 2, (size_t)SPLIT_OBJECTS_PAYLOAD);
+
+    exchange();
+    bool keymap_first = slave.keymap.mods == 0x01;
+    EXPECT_NE(keymap_first, slave.screen[0] == 0xAA);
+
+    for (int i = 0; i < 3; i++) {
+        exchange();
+    }
+    EXPECT_EQ(slave.keymap.mods, 0x01);
+    EXPECT_EQ(slave.screen[7], 0xAA);
+}
+
+TEST_F(SplitObjectsTest, TestPeriodicAndOnDemand) {
+    settle();
+
+    // Writes alone don't send either of these
+    uint16_t clock = 1234;
+    split_object_write(&master.clock_object, &clock);
+    memset(master.screen, 0x55, sizeof(master.screen));
+    exchange();
+    exchange();
+    EXPECT_EQ(slave.clock, 0);
+    EXPECT_EQ(slave.screen[0], 0);
+
+    advance_time(500);
+    exchange();
+    EXPECT_EQ(slave.clock, 1234);
+
+    split_object_request(&master.screen_object);
+    exchange();
+    exchange();
+    EXPECT_EQ(slave.screen[0], 0x55);
+}
+
+TEST_F(SplitObjectsTest, TestRestartedHalfGetsEverythingAgain) {
+    keymap_state_t state = {.mods = 0x08, .layers = 0x03};
+    split_object_write(&master.keymap_object, &state);
+    settle();
+    EXPECT_EQ(slave.keymap.layers, 0x03u);
+
+    // The slave reboots: fresh registry, objects back to zero
+    memset(&slave.keymap, 0, sizeof(slave.keymap));
+    slave.init();
+    memset(s2m, 0, sizeof(s2m));
+    settle();
+    EXPECT_EQ(slave.keymap.mods, 0x08);
+    EXPECT_EQ(slave.keymap.layers, 0x03u);
+}
+
+TEST_F(SplitObjectsTest, TestRegistrationLimits) {
+    split_registry_t registry;
+    split_registry_init(&registry);
+
+    uint8_t         big[SPLIT_OBJECTS_PAYLOAD];
+    split_object_t  big_object = {big, sizeof(big), SPLIT_MASTER_TO_SLAVE, SPLIT_SYNC_ON_CHANGE, 0};
+    split_object_t *too_big[]  = {&big_object};
+    EXPECT_FALSE(split_registry_add(&registry, too_big, 1));
+
+    split_object_t *many[SPLIT_OBJECTS_MAX + 1];
+    for (auto &object : many) {
+        object = &master.keymap_object;
+    }
+    EXPECT_FALSE(split_registry_add(&registry, many, SPLIT_OBJECTS_MAX + 1));
+    EXPECT_TRUE(split_registry_add(&registry, many, SPLIT_OBJECTS_MAX));
+    EXPECT_EQ(registry.count, SPLIT_OBJECTS_MAX);
+}
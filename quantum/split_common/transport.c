@@ -15,20 +15,47 @@
 #    include "backlight.h"
 #endif
 
+#ifdef SPLIT_TRANSPORT_OBJECTS
+#    include "split_objects.h"
+#endif
+
+#ifdef SPLIT_EVENT_TIMESTAMPS
+#    include "split_events.h"
+#endif
+
 #ifdef ENCODER_ENABLE
 #    include "encoder.h"
 static pin_t encoders_pad[] = ENCODERS_PAD_A;
 #    define NUMBER_OF_ENCODERS (sizeof(encoders_pad) / sizeof(pin_t))
 #endif
 
+#ifdef SPLIT_TRANSPORT_DELTA
+// Both halves must run the same layout, bump this whenever it changes
+#    define SPLIT_TRANSPORT_VERSION 2
+
+// The slave bumps its sequence number whenever its matrix or encoder state
+// changes, the master only fetches that state when the number moves on.
+static uint8_t slave_sequence;
+static uint8_t master_sequence;
+static bool    master_synced;
+#endif
+
+
 #if defined(USE_I2C)
 
 #    include "i2c_master.h"
 #    include "i2c_slave.h"
 
 typedef struct _I2C_slave_buffer_t {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t version;
+    uint8_t sequence;
+#    endif
     matrix_row_t smatrix[ROWS_PER_HAND];
-    uint8_t      backlight_level;
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_key_age_t key_ages[SPLIT_EVENT_COUNT];  // read along with the matrix
+#    endif
+    uint8_t backlight_level;
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     rgblight_syncinfo_t rgblight_sync;
 #    endif
@@ -38,6 +65,10 @@ typedef struct _I2C_slave_buffer_t {
 #    ifdef WPM_ENABLE
     uint8_t current_wpm;
 #    endif
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+    uint8_t objects_m2s[SPLIT_OBJECTS_BUDGET];
+    uint8_t objects_s2m[SPLIT_OBJECTS_BUDGET];
+#    endif
 } I2C_slave_buffer_t;
 
 static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_reg;
@@ -47,6 +78,19 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #    define I2C_KEYMAP_START offsetof(I2C_slave_buffer_t, smatrix)
 #    define I2C_ENCODER_START offsetof(I2C_slave_buffer_t, encoder_state)
 #    define I2C_WPM_START offsetof(I2C_slave_buffer_t, current_wpm)
+#    define I2C_VERSION_START offsetof(I2C_slave_buffer_t, version)
+#    define I2C_OBJECTS_M2S_START offsetof(I2C_slave_buffer_t, objects_m2s)
+#    define I2C_OBJECTS_S2M_START offsetof(I2C_slave_buffer_t, objects_s2m)
+
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+#        define I2C_KEYMAP_SIZE (offsetof(I2C_slave_buffer_t, key_ages) + sizeof(i2c_buffer->key_ages) - I2C_KEYMAP_START)
+#    else
+#        define I2C_KEYMAP_SIZE sizeof(i2c_buffer->smatrix)
+#    endif
+
+#    if defined(SPLIT_TRANSPORT_OBJECTS) || defined(SPLIT_EVENT_TIMESTAMPS)
+_Static_assert(sizeof(I2C_slave_buffer_t) <= I2C_SLAVE_REG_COUNT, "I2C_SLAVE_REG_COUNT is too small for the slave buffer");
+#    endif
 
 #    define TIMEOUT 100
 
@@ -54,9 +98,39 @@ static I2C_slave_buffer_t *const i2c_buffer = (I2C_slave_buffer_t *)i2c_slave_re
 #        define SLAVE_I2C_ADDRESS 0x32
 #    endif
 
+// The master's own copy of the slave buffer is unused, so rows are read into it first
+static bool read_slave_matrix(matrix_row_t matrix[]) {
+    if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_START, (void *)i2c_buffer->smatrix, I2C_KEYMAP_SIZE, TIMEOUT) < 0) {
+        return false;
+    }
+    memcpy((void *)matrix, (void *)i2c_buffer->smatrix, sizeof(i2c_buffer->smatrix));
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_receive(i2c_buffer->key_ages);
+#    endif
+    return true;
+}
+
 // Get rows from other half over i2c
 bool transport_master(matrix_row_t matrix[]) {
-    i2c_readReg(SLAVE_I2C_ADDRESS, I2C_KEYMAP_START, (void *)matrix, sizeof(i2c_buffer->smatrix), TIMEOUT);
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // Version and sequence number are adjacent, one read checks both
+    uint8_t header[2];
+    if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_VERSION_START, header, sizeof(header), TIMEOUT) < 0 || header[0] != SPLIT_TRANSPORT_VERSION) {
+        master_synced = false;
+        return false;
+    }
+    bool slave_changed = !master_synced || header[1] != master_sequence;
+    if (slave_changed) {
+        if (!read_slave_matrix(matrix)) {
+            master_synced = false;
+            return false;
+        }
+        master_sequence = header[1];
+        master_synced   = true;
+    }
+#    else
+    read_slave_matrix(matrix);
+#    endif
 
     // write backlight info
 #    ifdef BACKLIGHT_ENABLE
@@ -79,8 +153,13 @@ bool transport_master(matrix_row_t matrix[]) {
 #    endif
 
 #    ifdef ENCODER_ENABLE
-    i2c_readReg(SLAVE_I2C_ADDRESS, I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state), TIMEOUT);
-    encoder_update_raw(i2c_buffer->encoder_state);
+#        ifdef SPLIT_TRANSPORT_DELTA
+    if (slave_changed)
+#        endif
+    {
+        i2c_readReg(SLAVE_I2C_ADDRESS, I2C_ENCODER_START, (void *)i2c_buffer->encoder_state, sizeof(i2c_buffer->encoder_state), TIMEOUT);
+        encoder_update_raw(i2c_buffer->encoder_state);
+    }
 #    endif
 
 #    ifdef WPM_ENABLE
@@ -91,12 +170,36 @@ bool transport_master(matrix_row_t matrix[]) {
         }
     }
 #    endif
+
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+    if (split_registry.count) {
+        // The mailbox is resent until acknowledged, only write it when it changed
+        static uint8_t objects_m2s[SPLIT_OBJECTS_BUDGET];
+        uint8_t        mailbox[SPLIT_OBJECTS_BUDGET];
+        split_registry_pack(&split_registry, mailbox, SPLIT_MASTER_TO_SLAVE);
+        if (memcmp(mailbox, objects_m2s, sizeof(mailbox)) != 0) {
+            if (i2c_writeReg(SLAVE_I2C_ADDRESS, I2C_OBJECTS_M2S_START, mailbox, sizeof(mailbox), TIMEOUT) >= 0) {
+                memcpy(objects_m2s, mailbox, sizeof(mailbox));
+            }
+        }
+        if (i2c_readReg(SLAVE_I2C_ADDRESS, I2C_OBJECTS_S2M_START, mailbox, sizeof(mailbox), TIMEOUT) >= 0) {
+            split_registry_unpack(&split_registry, mailbox, SPLIT_SLAVE_TO_MASTER);
+        }
+    }
+#    endif
     return true;
 }
 
 void transport_slave(matrix_row_t matrix[]) {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    bool changed = memcmp((void *)i2c_buffer->smatrix, (void *)matrix, sizeof(i2c_buffer->smatrix)) != 0;
+#    endif
     // Copy matrix to I2C buffer
     memcpy((void *)i2c_buffer->smatrix, (void *)matrix, sizeof(i2c_buffer->smatrix));
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_record(matrix);
+    split_events_publish(i2c_buffer->key_ages);
+#    endif
 
 // Read Backlight Info
 #    ifdef BACKLIGHT_ENABLE
@@ -112,41 +215,125 @@ void transport_slave(matrix_row_t matrix[]) {
 #    endif
 
 #    ifdef ENCODER_ENABLE
+#        ifdef SPLIT_TRANSPORT_DELTA
+    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+    encoder_state_raw(encoder_state);
+    if (memcmp(i2c_buffer->encoder_state, encoder_state, sizeof(encoder_state)) != 0) {
+        memcpy(i2c_buffer->encoder_state, encoder_state, sizeof(encoder_state));
+        changed = true;
+    }
+#        else
     encoder_state_raw(i2c_buffer->encoder_state);
+#        endif
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+    // Publish the sequence number after the data it describes
+    if (changed) {
+        i2c_buffer->sequence = ++slave_sequence;
+    }
 #    endif
 
 #    ifdef WPM_ENABLE
     set_current_wpm(i2c_buffer->current_wpm);
 #    endif
+
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+    if (split_registry.count) {
+        split_registry_unpack(&split_registry, (uint8_t *)i2c_buffer->objects_m2s, SPLIT_MASTER_TO_SLAVE);
+        split_registry_pack(&split_registry, (uint8_t *)i2c_buffer->objects_s2m, SPLIT_SLAVE_TO_MASTER);
+    }
+#    endif
 }
 
-void transport_master_init(void) { i2c_init(); }
+void transport_master_init(void) {
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_init();
+#    endif
+    i2c_init();
+}
 
-void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
+void transport_slave_init(void) {
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_init();
+#    endif
+    i2c_slave_init(SLAVE_I2C_ADDRESS);
+#    ifdef SPLIT_TRANSPORT_DELTA
+    i2c_buffer->version = SPLIT_TRANSPORT_VERSION;
+#    endif
+}
 
 #else  // USE_SERIAL
 
 #    include "serial.h"
 
+#    ifdef SPLIT_TRANSPORT_DELTA
+// Rows are packed back to back, so only MATRIX_COLS bits per row go over the wire
+#        define PACKED_MATRIX_SIZE ((ROWS_PER_HAND * MATRIX_COLS + 7) / 8)
+
+// Exchanged on every scan: the slave's version and sequence number, and the
+// master's state that the slave mirrors, applied there only when it changes.
+typedef struct _Serial_status_s2m_t {
+    uint8_t version;
+    uint8_t sequence;
+} Serial_status_s2m_t;
+
+typedef struct _Serial_status_m2s_t {
+#        ifdef BACKLIGHT_ENABLE
+    uint8_t backlight_level;
+#        endif
+#        ifdef WPM_ENABLE
+    uint8_t current_wpm;
+#        endif
+} Serial_status_m2s_t;
+
+// Only fetched when the sequence number has moved on
+typedef struct _Serial_s2m_buffer_t {
+    uint8_t packed_matrix[PACKED_MATRIX_SIZE];
+#        ifdef ENCODER_ENABLE
+    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+#        endif
+#        ifdef SPLIT_EVENT_TIMESTAMPS
+    split_key_age_t key_ages[SPLIT_EVENT_COUNT];
+#        endif
+} Serial_s2m_buffer_t;
+
+// Everything before the key ages is state, changes to it bump the sequence number
+#        ifdef SPLIT_EVENT_TIMESTAMPS
+#            define SERIAL_S2M_STATE_SIZE offsetof(Serial_s2m_buffer_t, key_ages)
+#        else
+#            define SERIAL_S2M_STATE_SIZE sizeof(Serial_s2m_buffer_t)
+#        endif
+
+volatile Serial_status_s2m_t serial_status_s2m = {};
+volatile Serial_status_m2s_t serial_status_m2s = {};
+uint8_t volatile status_slave_status           = 0;
+#    else
 typedef struct _Serial_s2m_buffer_t {
     // TODO: if MATRIX_COLS > 8 change to uint8_t packed_matrix[] for pack/unpack
     matrix_row_t smatrix[ROWS_PER_HAND];
 
-#    ifdef ENCODER_ENABLE
+#        ifdef ENCODER_ENABLE
     uint8_t      encoder_state[NUMBER_OF_ENCODERS];
-#    endif
+#        endif
 
+#        ifdef SPLIT_EVENT_TIMESTAMPS
+    split_key_age_t key_ages[SPLIT_EVENT_COUNT];
+#        endif
 } Serial_s2m_buffer_t;
 
 typedef struct _Serial_m2s_buffer_t {
-#    ifdef BACKLIGHT_ENABLE
+#        ifdef BACKLIGHT_ENABLE
     uint8_t backlight_level;
-#    endif
-#    ifdef WPM_ENABLE
+#        endif
+#        ifdef WPM_ENABLE
     uint8_t current_wpm;
-#    endif
+#        endif
 } Serial_m2s_buffer_t;
 
+volatile Serial_m2s_buffer_t serial_m2s_buffer = {};
+#    endif
+
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 // When MCUs on both sides drive their respective RGB LED chains,
 // it is necessary to synchronize, so it is necessary to communicate RGB
@@ -164,18 +351,43 @@ volatile Serial_rgblight_t serial_rgblight = {};
 uint8_t volatile status_rgblight           = 0;
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+volatile uint8_t serial_objects_m2s[SPLIT_OBJECTS_BUDGET] = {};
+volatile uint8_t serial_objects_s2m[SPLIT_OBJECTS_BUDGET] = {};
+uint8_t volatile status_objects                           = 0;
+#    endif
+
 volatile Serial_s2m_buffer_t serial_s2m_buffer = {};
-volatile Serial_m2s_buffer_t serial_m2s_buffer = {};
 uint8_t volatile status0                       = 0;
 
 enum serial_transaction_id {
     GET_SLAVE_MATRIX = 0,
+#    ifdef SPLIT_TRANSPORT_DELTA
+    GET_SLAVE_STATUS,
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     PUT_RGBLIGHT,
 #    endif
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+    EXCHANGE_OBJECTS,
+#    endif
 };
 
 SSTD_t transactions[] = {
+#    ifdef SPLIT_TRANSPORT_DELTA
+    [GET_SLAVE_MATRIX] =
+        {
+            (uint8_t *)&status0, 0, NULL, sizeof(serial_s2m_buffer), (uint8_t *)&serial_s2m_buffer  // no master to slave transfer
+        },
+    [GET_SLAVE_STATUS] =
+        {
+            (uint8_t *)&status_slave_status,
+            sizeof(serial_status_m2s),
+            (uint8_t *)&serial_status_m2s,
+            sizeof(serial_status_s2m),
+            (uint8_t *)&serial_status_s2m,
+        },
+#    else
     [GET_SLAVE_MATRIX] =
         {
             (uint8_t *)&status0,
@@ -184,17 +396,41 @@ SSTD_t transactions[] = {
             sizeof(serial_s2m_buffer),
             (uint8_t *)&serial_s2m_buffer,
         },
+#    endif
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
     [PUT_RGBLIGHT] =
         {
             (uint8_t *)&status_rgblight, sizeof(serial_rgblight), (uint8_t *)&serial_rgblight, 0, NULL  // no slave to master transfer
         },
 #    endif
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+    [EXCHANGE_OBJECTS] =
+        {
+            (uint8_t *)&status_objects,
+            sizeof(serial_objects_m2s),
+            (uint8_t *)serial_objects_m2s,
+            sizeof(serial_objects_s2m),
+            (uint8_t *)serial_objects_s2m,
+        },
+#    endif
 };
 
-void transport_master_init(void) { soft_serial_initiator_init(transactions, TID_LIMIT(transactions)); }
+void transport_master_init(void) {
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_init();
+#    endif
+    soft_serial_initiator_init(transactions, TID_LIMIT(transactions));
+}
 
-void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMIT(transactions)); }
+void transport_slave_init(void) {
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_init();
+#    endif
+#    ifdef SPLIT_TRANSPORT_DELTA
+    serial_status_s2m.version = SPLIT_TRANSPORT_VERSION;
+#    endif
+    soft_serial_target_init(transactions, TID_LIMIT(transactions));
+}
 
 #    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
 
@@ -221,6 +457,137 @@ void transport_rgblight_slave(void) {
 #        define transport_rgblight_slave()
 #    endif
 
+#    ifdef SPLIT_TRANSPORT_OBJECTS
+
+// Shared objects, one mailbox each way per scan, see split_objects.h
+
+void transport_objects_master(void) {
+    if (split_registry.count) {
+        split_registry_pack(&split_registry, (uint8_t *)serial_objects_m2s, SPLIT_MASTER_TO_SLAVE);
+        if (soft_serial_transaction(EXCHANGE_OBJECTS) == TRANSACTION_END) {
+            split_registry_unpack(&split_registry, (uint8_t *)serial_objects_s2m, SPLIT_SLAVE_TO_MASTER);
+        }
+    }
+}
+
+void transport_objects_slave(void) {
+    if (split_registry.count) {
+        split_registry_unpack(&split_registry, (uint8_t *)serial_objects_m2s, SPLIT_MASTER_TO_SLAVE);
+        split_registry_pack(&split_registry, (uint8_t *)serial_objects_s2m, SPLIT_SLAVE_TO_MASTER);
+    }
+}
+
+#    else
+#        define transport_objects_master()
+#        define transport_objects_slave()
+#    endif
+
+#    ifdef SPLIT_TRANSPORT_DELTA
+
+static void matrix_pack(uint8_t *packed, const matrix_row_t matrix[]) {
+    memset(packed, 0, PACKED_MATRIX_SIZE);
+    uint16_t bit = 0;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, bit++) {
+            if (matrix[row] & ((matrix_row_t)1 << col)) {
+                packed[bit / 8] |= 1 << (bit % 8);
+            }
+        }
+    }
+}
+
+static void matrix_unpack(matrix_row_t matrix[], const uint8_t *packed) {
+    uint16_t bit = 0;
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        matrix_row_t value = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++, bit++) {
+            if (packed[bit / 8] & (1 << (bit % 8))) {
+                value |= (matrix_row_t)1 << col;
+            }
+        }
+        matrix[row] = value;
+    }
+}
+
+bool transport_master(matrix_row_t matrix[]) {
+    transport_rgblight_master();
+    transport_objects_master();
+
+#        ifdef BACKLIGHT_ENABLE
+    serial_status_m2s.backlight_level = is_backlight_enabled() ? get_backlight_level() : 0;
+#        endif
+#        ifdef WPM_ENABLE
+    serial_status_m2s.current_wpm = get_current_wpm();
+#        endif
+
+    if (soft_serial_transaction(GET_SLAVE_STATUS) != TRANSACTION_END || serial_status_s2m.version != SPLIT_TRANSPORT_VERSION) {
+        master_synced = false;
+        return false;
+    }
+
+    // Nothing changed on the slave, keep the rows we already have
+    uint8_t sequence = serial_status_s2m.sequence;
+    if (master_synced && sequence == master_sequence) {
+        return true;
+    }
+
+    if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
+        master_synced = false;
+        return false;
+    }
+
+    matrix_unpack(matrix, (uint8_t *)serial_s2m_buffer.packed_matrix);
+#        ifdef ENCODER_ENABLE
+    encoder_update_raw((uint8_t *)serial_s2m_buffer.encoder_state);
+#        endif
+#        ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_receive((split_key_age_t *)serial_s2m_buffer.key_ages);
+#        endif
+
+    // The slave publishes the sequence number after the data, so the rows are at least
+    // as new as it. If they were being updated during the fetch, the next status differs.
+    master_sequence = sequence;
+    master_synced   = true;
+    return true;
+}
+
+void transport_slave(matrix_row_t matrix[]) {
+    transport_rgblight_slave();
+    transport_objects_slave();
+
+    Serial_s2m_buffer_t next;
+    matrix_pack(next.packed_matrix, matrix);
+#        ifdef ENCODER_ENABLE
+    encoder_state_raw(next.encoder_state);
+#        endif
+
+    if (memcmp(&next, (uint8_t *)&serial_s2m_buffer, SERIAL_S2M_STATE_SIZE) != 0) {
+        memcpy((uint8_t *)&serial_s2m_buffer, &next, SERIAL_S2M_STATE_SIZE);
+        // Publish the sequence number after the data it describes
+        serial_status_s2m.sequence = ++slave_sequence;
+    }
+
+#        ifdef SPLIT_EVENT_TIMESTAMPS
+    // Ages move on every scan without a new sequence number, so a fetch always gets fresh ones
+    split_events_record(matrix);
+    split_events_publish((split_key_age_t *)serial_s2m_buffer.key_ages);
+#        endif
+
+#        ifdef BACKLIGHT_ENABLE
+    static uint8_t backlight_level = 0;
+    if (serial_status_m2s.backlight_level != backlight_level) {
+        backlight_level = serial_status_m2s.backlight_level;
+        backlight_set(backlight_level);
+    }
+#        endif
+
+#        ifdef WPM_ENABLE
+    set_current_wpm(serial_status_m2s.current_wpm);
+#        endif
+}
+
+#    else
+
 bool transport_master(matrix_row_t matrix[]) {
 #    ifndef SERIAL_USE_MULTI_TRANSACTION
     if (soft_serial_transaction() != TRANSACTION_END) {
@@ -228,6 +595,7 @@ bool transport_master(matrix_row_t matrix[]) {
     }
 #    else
     transport_rgblight_master();
+    transport_objects_master();
     if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
         return false;
     }
@@ -237,6 +605,9 @@ bool transport_master(matrix_row_t matrix[]) {
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         matrix[i] = serial_s2m_buffer.smatrix[i];
     }
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_receive((split_key_age_t *)serial_s2m_buffer.key_ages);
+#    endif
 
 #    ifdef BACKLIGHT_ENABLE
     // Write backlight level for slave to read
@@ -256,10 +627,15 @@ bool transport_master(matrix_row_t matrix[]) {
 
 void transport_slave(matrix_row_t matrix[]) {
     transport_rgblight_slave();
+    transport_objects_slave();
     // TODO: if MATRIX_COLS > 8 change to pack()
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_s2m_buffer.smatrix[i] = matrix[i];
     }
+#    ifdef SPLIT_EVENT_TIMESTAMPS
+    split_events_record(matrix);
+    split_events_publish((split_key_age_t *)serial_s2m_buffer.key_ages);
+#    endif
 #    ifdef BACKLIGHT_ENABLE
     backlight_set(serial_m2s_buffer.backlight_level);
 #    endif
@@ -273,4 +649,6 @@ void transport_slave(matrix_row_t matrix[]) {
 #    endif
 }
 
+#    endif
+
 #endif
@@ -0,0 +1,94 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* hsv_to_rgb_n must match hsv_to_rgb for every color, whichever way it is
+ * built. With QMK_BENCHMARK set, the benchmark prints the time per pixel of
+ * both, so the batch kernel can be compared to the scalar one on the host.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <vector>
+#include "test_ticks.hpp"
+
+extern "C" {
+#include "color.h"
+}
+
+#define BENCHMARK_ROUNDS 64
+
+// Every h and s for one v, the batch size rgb_matrix would use is far smaller but any n must work
+static std::vector<HSV> all_colors(uint8_t v) {
+    std::vector<HSV> colors;
+    for (uint16_t h = 0; h < 256; h++) {
+        for (uint16_t s = 0; s < 256; s++) {
+            colors.push_back({(uint8_t)h, (uint8_t)s, v});
+        }
+    }
+    return colors;
+}
+
+TEST(HsvToRgb, BatchMatchesScalar) {
+    std::vector<RGB> rgb(256 * 256);
+    for (uint16_t v = 0; v < 256; v++) {
+        std::vector<HSV> hsv = all_colors(v);
+        for (size_t i = 0; i < hsv.size(); i += 255) {
+            hsv_to_rgb_n(&hsv[i], &rgb[i], std::min<size_t>(255, hsv.size() - i));
+        }
+        for (size_t i = 0; i < hsv.size(); i++) {
+            RGB expected = hsv_to_rgb(hsv[i]);
+            ASSERT_EQ(expected.r, rgb[i].r) << "h " << +hsv[i].h << " s " << +hsv[i].s << " v " << +hsv[i].v;
+            ASSERT_EQ(expected.g, rgb[i].g) << "h " << +hsv[i].h << " s " << +hsv[i].s << " v " << +hsv[i].v;
+            ASSERT_EQ(expected.b, rgb[i].b) << "h " << +hsv[i].h << " s " << +hsv[i].s << " v " << +hsv[i].v;
+        }
+    }
+}
+
+TEST(HsvToRgb, EmptyBatchWritesNothing) {
+    HSV hsv = {10, 20, 30};
+    RGB rgb = {};
+    rgb.r   = 1;
+    hsv_to_rgb_n(&hsv, &rgb, 0);
+    EXPECT_EQ(rgb.r, 1);
+}
+
+TEST(HsvToRgb, Benchmark) {
+    if (!benchmark_enabled()) GTEST_SKIP();
+
+    std::vector<HSV> hsv = all_colors(200);
+    std::vector<RGB> rgb(hsv.size());
+    uint64_t         scalar = 0, batch = 0;
+    uint32_t         check  = 0;
+
+    for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+        uint64_t start = read_ticks();
+        for (size_t i = 0; i < hsv.size(); i++) {
+            rgb[i] = hsv_to_rgb(hsv[i]);
+        }
+        scalar += read_ticks() - start;
+        check += rgb[round].r;
+
+        start = read_ticks();
+        for (size_t i = 0; i < hsv.size(); i += 16) {
+            hsv_to_rgb_n(&hsv[i], &rgb[i], 16);
+        }
+        batch += read_ticks() - start;
+        check += rgb[round].r;
+    }
+
+    double pixels = (double)hsv.size() * BENCHMARK_ROUNDS;
+    printf("hsv_to_rgb %6.2f ticks/pixel, hsv_to_rgb_n %6.2f ticks/pixel (%u)\n", scalar / pixels, batch / pixels, check);
+}
@@ -0,0 +1,14 @@
+color_hsv_to_rgb_INC := $(TOP_DIR)/tests/test_common
+color_hsv_to_rgb_SRC := \
+	$(QUANTUM_PATH)/tests/color_tests.cpp \
+	$(QUANTUM_PATH)/color.c
+
+color_hsv_to_rgb_unpacked_DEFS := -DHSV_TO_RGB_NO_PACKED
+color_hsv_to_rgb_unpacked_INC := $(color_hsv_to_rgb_INC)
+color_hsv_to_rgb_unpacked_SRC := $(color_hsv_to_rgb_SRC)
+
+color_hsv_to_rgb_cie_DEFS := -DUSE_CIE1931_CURVE
+color_hsv_to_rgb_cie_INC := $(color_hsv_to_rgb_INC)
+color_hsv_to_rgb_cie_SRC := \
+	$(color_hsv_to_rgb_SRC) \
+	$(QUANTUM_PATH)/led_tables.c
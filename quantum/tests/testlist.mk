@@ -0,0 +1,3 @@
+TEST_LIST += color_hsv_to_rgb
+TEST_LIST += color_hsv_to_rgb_unpacked
+TEST_LIST += color_hsv_to_rgb_cie
@@ -44,6 +44,7 @@
 
 #include "raw_hid.h"
 #include "dynamic_keymap.h"
+#include "profiler.h"
 #include "tmk_core/common/eeprom.h"
 #include "version.h"  // for QMK_BUILDDATE used in EEPROM magic
 
@@ -66,7 +67,9 @@ bool via_eeprom_is_valid(void) {
     uint8_t magic1 = ((p[5] & 0x0F) << 4) | (p[6] & 0x0F);
     uint8_t magic2 = ((p[8] & 0x0F) << 4) | (p[9] & 0x0F);
 
-    return (eeprom_read_byte((void *)VIA_EEPROM_MAGIC_ADDR + 0) == magic0 && eeprom_read_byte((void *)VIA_EEPROM_MAGIC_ADDR + 1) == magic1 && eeprom_read_byte((void *)VIA_EEPROM_MAGIC_ADDR + 2) == magic2);
+    uint8_t magic[3];
+    eeprom_read_block(magic, (void *)VIA_EEPROM_MAGIC_ADDR, sizeof(magic));
+    return (magic[0] == magic0 && magic[1] == magic1 && magic[2] == magic2);
 }
 
 // Sets VIA/keyboard level usage of EEPROM to valid/invalid
@@ -77,9 +80,8 @@ void via_eeprom_set_valid(bool valid) {
     uint8_t magic1 = ((p[5] & 0x0F) << 4) | (p[6] & 0x0F);
     uint8_t magic2 = ((p[8] & 0x0F) << 4) | (p[9] & 0x0F);
 
-    eeprom_update_byte((void *)VIA_EEPROM_MAGIC_ADDR + 0, valid ? magic0 : 0xFF);
-    eeprom_update_byte((void *)VIA_EEPROM_MAGIC_ADDR + 1, valid ? magic1 : 0xFF);
-    eeprom_update_byte((void *)VIA_EEPROM_MAGIC_ADDR + 2, valid ? magic2 : 0xFF);
+    uint8_t magic[3] = {valid ? magic0 : 0xFF, valid ? magic1 : 0xFF, valid ? magic2 : 0xFF};
+    eeprom_update_block(magic, (void *)VIA_EEPROM_MAGIC_ADDR, sizeof(magic));
 }
 
 // Flag QMK and VIA/keyboard level EEPROM as invalid.
@@ -125,24 +127,24 @@ void via_init(void) {
 // variable, between 1 and 4 bytes.
 uint32_t via_get_layout_options(void) {
     uint32_t value = 0;
+    uint8_t  data[VIA_EEPROM_LAYOUT_OPTIONS_SIZE];
+    eeprom_read_block(data, (void *)(VIA_EEPROM_LAYOUT_OPTIONS_ADDR), sizeof(data));
     // Start at the most significant byte
-    void *source = (void *)(VIA_EEPROM_LAYOUT_OPTIONS_ADDR);
     for (uint8_t i = 0; i < VIA_EEPROM_LAYOUT_OPTIONS_SIZE; i++) {
         value = value << 8;
-        value |= eeprom_read_byte(source);
-        source++;
+        value |= data[i];
     }
     return value;
 }
 
 void via_set_layout_options(uint32_t value) {
+    uint8_t data[VIA_EEPROM_LAYOUT_OPTIONS_SIZE];
     // Start at the least significant byte
-    void *target = (void *)(VIA_EEPROM_LAYOUT_OPTIONS_ADDR + VIA_EEPROM_LAYOUT_OPTIONS_SIZE - 1);
-    for (uint8_t i = 0; i < VIA_EEPROM_LAYOUT_OPTIONS_SIZE; i++) {
-        eeprom_update_byte(target, value & 0xFF);
-        value = value >> 8;
-        target--;
+    for (int8_t i = VIA_EEPROM_LAYOUT_OPTIONS_SIZE - 1; i >= 0; i--) {
+        data[i] = value & 0xFF;
+        value   = value >> 8;
     }
+    eeprom_update_block(data, (void *)(VIA_EEPROM_LAYOUT_OPTIONS_ADDR), sizeof(data));
 }
 
 // Called by QMK core to process VIA-specific keycodes.
@@ -245,6 +247,33 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
 #endif
                     break;
                 }
+#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_FRAME_STATS)
+                case id_rgb_matrix_frame_stats: {
+                    const rgb_matrix_frame_stats_t *stats    = rgb_matrix_get_frame_stats();
+                    uint32_t                        values[] = {stats->frames, stats->frames_dropped, stats->render_us, stats->render_us_max, stats->flush_us, stats->flush_us_max};
+                    uint8_t                         i        = 1;
+                    for (uint8_t j = 0; j < sizeof(values) / sizeof(values[0]); j++) {
+                        command_data[i++] = (values[j] >> 24) & 0xFF;
+                        command_data[i++] = (values[j] >> 16) & 0xFF;
+                        command_data[i++] = (values[j] >> 8) & 0xFF;
+                        command_data[i++] = values[j] & 0xFF;
+                    }
+                    break;
+                }
+#endif
+#ifdef PROFILER_ENABLE
+                case id_main_loop_profile: {
+                    // command_data[1] selects the profile_stage_t
+                    profile_stats_t stats    = profile_get_stats(command_data[1]);
+                    uint16_t        values[] = {stats.samples, stats.min, stats.avg, stats.max, stats.p99};
+                    uint8_t         i        = 2;
+                    for (uint8_t j = 0; j < sizeof(values) / sizeof(values[0]); j++) {
+                        command_data[i++] = (values[j] >> 8) & 0xFF;
+                        command_data[i++] = values[j] & 0xFF;
+                    }
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
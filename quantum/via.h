@@ -82,9 +82,12 @@ enum via_command_id {
 };
 
 enum via_keyboard_value_id {
-    id_uptime              = 0x01,  //
-    id_layout_options      = 0x02,
-    id_switch_matrix_state = 0x03
+    id_uptime                 = 0x01,  //
+    id_layout_options         = 0x02,
+    id_switch_matrix_state    = 0x03,
+    // Diagnostics, kept clear of the ids the VIA Configurator uses
+    id_rgb_matrix_frame_stats = 0x80,
+    id_main_loop_profile      = 0x81
 };
 
 enum via_lighting_value {
@@ -17,7 +17,9 @@
 #include "test_common.hpp"
 
 using testing::_;
+using testing::AnyNumber;
 using testing::InSequence;
+using testing::Invoke;
 using testing::Return;
 
 class KeyPress : public TestFixture {};
@@ -40,23 +42,54 @@ TEST_F(KeyPress, CorrectKeyIsReportedWhenPressed) {
 
 TEST_F(KeyPress, CorrectKeysAreReportedWhenTwoKeysArePressed) {
     TestDriver driver;
+    InSequence s;
     press_key(1, 0);
     press_key(0, 3);
-    // Note that QMK only processes one key at a time
-    // See issue #1476 for more information
+    // Both keys are processed by the same scan, in matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_C)));
     keyboard_task();
     release_key(1, 0);
     release_key(0, 3);
     // Note that the first key released is the first one in the matrix order
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
     keyboard_task();
 }
 
+TEST_F(KeyPress, SixKeyChordIsReportedAfterOneScanLoop) {
+    TestDriver driver;
+    bool       chord_reported = false;
+    unsigned   scan_loops     = 0;
+
+    // KC_A, KC_B, KC_LSFT, KC_EQL, KC_C and KC_D
+    press_key(0, 0);
+    press_key(1, 0);
+    press_key(3, 0);
+    press_key(0, 1);
+    press_key(0, 3);
+    press_key(1, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_B, KC_LSFT, KC_EQL, KC_C, KC_D))).WillOnce(Invoke([&](report_keyboard_t&) { chord_reported = true; }));
+    while (!chord_reported && scan_loops < 10) {
+        run_one_scan_loop();
+        scan_loops++;
+    }
+    EXPECT_EQ(scan_loops, 1u);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    bool released = false;
+    scan_loops    = 0;
+    clear_all_keys();
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).WillOnce(Invoke([&](report_keyboard_t&) { released = true; }));
+    while (!released && scan_loops < 10) {
+        run_one_scan_loop();
+        scan_loops++;
+    }
+    EXPECT_EQ(scan_loops, 1u);
+}
+
 TEST_F(KeyPress, ANonMappedKeyDoesNothing) {
     TestDriver driver;
     press_key(2, 0);
@@ -67,12 +100,12 @@ TEST_F(KeyPress, ANonMappedKeyDoesNothing) {
 
 TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
     TestDriver driver;
+    InSequence s;
     press_key(3, 0);
     press_key(0, 0);
     // Unfortunately modifiers are also processed in the wrong order
     // See issue #1476 for more information
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_LSFT)));
     keyboard_task();
     release_key(0, 0);
@@ -85,24 +118,24 @@ TEST_F(KeyPress, LeftShiftIsReportedCorrectly) {
 
 TEST_F(KeyPress, PressLeftShiftAndControl) {
     TestDriver driver;
+    InSequence s;
     press_key(3, 0);
     press_key(5, 0);
     // Unfortunately modifiers are also processed in the wrong order
     // See issue #1476 for more information
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_LCTRL)));
     keyboard_task();
 }
 
 TEST_F(KeyPress, LeftAndRightShiftCanBePressedAtTheSameTime) {
     TestDriver driver;
+    InSequence s;
     press_key(3, 0);
     press_key(4, 0);
     // Unfortunately modifiers are also processed in the wrong order
     // See issue #1476 for more information
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
-    keyboard_task();
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_RSFT)));
     keyboard_task();
 }
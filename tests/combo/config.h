@@ -0,0 +1,27 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define MATRIX_ROWS 4
+#define MATRIX_COLS 10
+
+// Every pair of the first 16 keys, plus a few more at the end of the list
+#define PAIR_COMBO_KEYS 16
+#define PAIR_COMBO_COUNT (PAIR_COMBO_KEYS * (PAIR_COMBO_KEYS - 1) / 2)
+#define COMBO_COUNT (PAIR_COMBO_COUNT + 6)
+
+#define COMBO_TERM_PER_COMBO
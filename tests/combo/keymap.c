@@ -0,0 +1,79 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// Don't rearrange keys as the tests rely on the order
+
+const uint16_t PROGMEM
+               keymaps[][MATRIX_ROWS][MATRIX_COLS] =
+        {
+            [0] =
+                {
+                    // 0    1      2      3      4      5      6      7      8      9
+                    {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J},
+                    {KC_K, KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T},
+                    {KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z, KC_NO, KC_NO, KC_NO, KC_NO},
+                    {SFT_T(KC_SPC), KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+                },
+};
+
+enum combos { QRS_ESC = PAIR_COMBO_COUNT, AQ_ENT, QR_F1, VW_F2, SPCZ_F3, XYX_F4 };
+
+// KC_A to KC_P, pairs of them are filled in at init
+static uint16_t pair_combos[PAIR_COMBO_COUNT][3];
+
+const uint16_t PROGMEM qrs_combo[]  = {KC_Q, KC_R, KC_S, COMBO_END};
+const uint16_t PROGMEM aq_combo[]   = {KC_A, KC_Q, COMBO_END};
+const uint16_t PROGMEM qr_combo[]   = {KC_Q, KC_R, COMBO_END};
+const uint16_t PROGMEM vw_combo[]   = {KC_V, KC_W, COMBO_END};
+const uint16_t PROGMEM spcz_combo[] = {SFT_T(KC_SPC), KC_Z, COMBO_END};
+const uint16_t PROGMEM xyx_combo[]  = {KC_X, KC_Y, KC_X, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {
+    [QRS_ESC] = COMBO(qrs_combo, KC_ESC),
+    [AQ_ENT]  = COMBO(aq_combo, KC_ENT),
+    [QR_F1]   = COMBO(qr_combo, KC_F1),
+    [VW_F2]   = COMBO(vw_combo, KC_F2),
+    [SPCZ_F3] = COMBO(spcz_combo, KC_F3),
+    [XYX_F4]  = COMBO(xyx_combo, KC_F4),
+};
+
+uint16_t get_combo_term(uint16_t combo_index, combo_t *combo) { return combo_index == VW_F2 ? 20 : COMBO_TERM; }
+
+uint8_t combo_presses[COMBO_COUNT];
+uint8_t combo_releases[COMBO_COUNT];
+
+void keyboard_post_init_user(void) {
+    uint16_t index = 0;
+    for (uint16_t first = 0; first < PAIR_COMBO_KEYS; first++) {
+        for (uint16_t second = first + 1; second < PAIR_COMBO_KEYS; second++) {
+            pair_combos[index][0] = KC_A + first;
+            pair_combos[index][1] = KC_A + second;
+            pair_combos[index][2] = COMBO_END;
+            key_combos[index]     = (combo_t)COMBO_ACTION(pair_combos[index]);
+            index++;
+        }
+    }
+}
+
+void process_combo_event(uint16_t combo_index, bool pressed) {
+    if (pressed) {
+        combo_presses[combo_index]++;
+    } else {
+        combo_releases[combo_index]++;
+    }
+}
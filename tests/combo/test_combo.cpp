@@ -0,0 +1,307 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+extern "C" {
+extern uint8_t combo_presses[COMBO_COUNT];
+extern uint8_t combo_releases[COMBO_COUNT];
+}
+
+// Positions of the keys after KC_Z in keymap.c
+#define MT_SPC 30
+
+class Combo : public TestFixture {
+   protected:
+    void SetUp() override {
+        memset(combo_presses, 0, sizeof(combo_presses));
+        memset(combo_releases, 0, sizeof(combo_releases));
+    }
+
+    // KC_A + n is at col n % 10 of row n / 10
+    void press(uint8_t n) { press_key(n % MATRIX_COLS, n / MATRIX_COLS); }
+    void release(uint8_t n) { release_key(n % MATRIX_COLS, n / MATRIX_COLS); }
+
+    // Same order as keyboard_post_init_user in keymap.c
+    uint16_t pair_combo(uint8_t first, uint8_t second) {
+        uint16_t index = 0;
+        for (uint8_t i = 0; i < first; i++) {
+            index += PAIR_COMBO_KEYS - 1 - i;
+        }
+        return index + second - first - 1;
+    }
+
+    unsigned total(const uint8_t *events) {
+        unsigned sum = 0;
+        for (uint16_t i = 0; i < COMBO_COUNT; i++) {
+            sum += events[i];
+        }
+        return sum;
+    }
+};
+
+TEST_F(Combo, EveryPairComboFiresOnlyItself) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+
+    for (uint8_t first = 0; first < PAIR_COMBO_KEYS; first++) {
+        for (uint8_t second = first + 1; second < PAIR_COMBO_KEYS; second++) {
+            uint16_t index = pair_combo(first, second);
+            press(first);
+            press(second);
+            run_one_scan_loop();
+            ASSERT_EQ(combo_presses[index], 1) << "combo " << index;
+            release(first);
+            release(second);
+            run_one_scan_loop();
+            ASSERT_EQ(combo_releases[index], 1) << "combo " << index;
+            ASSERT_EQ(total(combo_presses), index + 1u) << "combo " << index;
+        }
+    }
+}
+
+TEST_F(Combo, LastCombosInTheListFire) {
+    TestDriver driver;
+    InSequence s;
+
+    press(16);
+    press(17);
+    press(18);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    run_one_scan_loop();
+    release(16);
+    release(17);
+    release(18);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+
+    // KC_A is in 15 other combos, none of which may claim this
+    press(0);
+    press(16);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ENT)));
+    run_one_scan_loop();
+    release(0);
+    release(16);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    EXPECT_EQ(total(combo_presses), 0u);
+}
+
+TEST_F(Combo, KeyInNoComboIsSentAtOnce) {
+    TestDriver driver;
+    InSequence s;
+
+    press(20);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_U)));
+    run_one_scan_loop();
+    release(20);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, LoneComboKeyIsSentAfterComboTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press(15);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(COMBO_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_P)));
+    idle_for(2);
+    release(15);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    EXPECT_EQ(total(combo_presses), 0u);
+}
+
+TEST_F(Combo, ComboKeysTooFarApartAreSentAsKeys) {
+    TestDriver driver;
+    InSequence s;
+
+    press(3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D)));
+    idle_for(COMBO_TERM + 2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // KC_J waits for a combo of its own, until KC_D going up settles it
+    press(9);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release(3);
+    release(9);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D, KC_J)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_J)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    EXPECT_EQ(total(combo_presses), 0u);
+}
+
+TEST_F(Combo, LongerComboWinsOverItsSubset) {
+    TestDriver driver;
+    InSequence s;
+
+    // KC_Q and KC_R are a combo, but also the start of KC_Q, KC_R and KC_S
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(16);
+    run_one_scan_loop();
+    press(17);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    press(18);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    run_one_scan_loop();
+    release(16);
+    release(17);
+    release(18);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, SubsetComboFiresOnRelease) {
+    TestDriver driver;
+    InSequence s;
+
+    press(16);
+    press(17);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release(17);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F1)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    release(16);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, SubsetComboFiresAfterComboTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press(16);
+    press(17);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(COMBO_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F1)));
+    idle_for(2);
+    release(16);
+    release(17);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ComboWithShorterTermFiresWithinIt) {
+    TestDriver driver;
+    InSequence s;
+
+    press(21);
+    idle_for(15);
+    press(22);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F2)));
+    run_one_scan_loop();
+    release(21);
+    release(22);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ComboWithShorterTermTimesOut) {
+    TestDriver driver;
+    InSequence s;
+
+    press(21);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(20);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_V)));
+    idle_for(2);
+    release(21);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, RepeatedKeycodeInComboFires) {
+    TestDriver driver;
+    InSequence s;
+
+    press(23);
+    press(24);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F4)));
+    run_one_scan_loop();
+    release(23);
+    release(24);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, TapHoldKeyInComboFires) {
+    TestDriver driver;
+    InSequence s;
+
+    press(MT_SPC);
+    press(25);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F3)));
+    run_one_scan_loop();
+    release(MT_SPC);
+    release(25);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, TapHoldKeyIsTappedAfterCombosLetItGo) {
+    TestDriver driver;
+    InSequence s;
+
+    // Replayed with its own time, so tapping still sees a short tap
+    press(MT_SPC);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release(MT_SPC);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_SPC)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, TapHoldKeyIsHeldAfterCombosLetItGo) {
+    TestDriver driver;
+    InSequence s;
+
+    press(MT_SPC);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    idle_for(COMBO_TERM + 10);
+    press(20);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_U)));
+    run_one_scan_loop();
+    release(MT_SPC);
+    release(20);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
@@ -0,0 +1,224 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "split_events.h"
+void set_time(uint32_t t);
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+#define SLAVE_ROW (MATRIX_ROWS / 2)
+// The halves do not share a clock, only ages go over the wire
+#define SLAVE_CLOCK_OFFSET 12345
+
+struct recorded_event_t {
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+    uint16_t time;
+};
+
+static std::vector<recorded_event_t> events;
+
+extern "C" {
+// What split_common/matrix.c does on the master
+uint16_t matrix_event_time(uint8_t row, uint8_t col) {
+    if (row >= SLAVE_ROW) {
+        return split_events_time(row - SLAVE_ROW, col);
+    }
+    return timer_read();
+}
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    events.push_back({record->event.key.row, record->event.key.col, record->event.pressed, record->event.time});
+    return true;
+}
+}
+
+class SplitEventTime : public TestFixture {
+   protected:
+    matrix_row_t slave_matrix[MATRIX_ROWS / 2] = {0};
+
+    void SetUp() override {
+        // Forget whatever the slave half held down in the previous test
+        split_events_record(slave_matrix);
+        split_events_init();
+        events.clear();
+    }
+
+    // The slave half sees a key change, the master does not know yet
+    void slave_change(uint8_t col, bool pressed) {
+        if (pressed) {
+            slave_matrix[0] |= (matrix_row_t)1 << col;
+        } else {
+            slave_matrix[0] &= ~((matrix_row_t)1 << col);
+        }
+        on_slave_clock([this] { split_events_record(slave_matrix); });
+    }
+
+    // One transport exchange, after which the master scans the slave's keys
+    void deliver() {
+        split_key_age_t ages[SPLIT_EVENT_COUNT];
+        on_slave_clock([&ages] { split_events_publish(ages); });
+        split_events_receive(ages);
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (slave_matrix[0] & ((matrix_row_t)1 << col)) {
+                press_key(col, SLAVE_ROW);
+            } else {
+                release_key(col, SLAVE_ROW);
+            }
+        }
+    }
+
+    template <typename F>
+    void on_slave_clock(F f) {
+        uint32_t now = timer_read32();
+        set_time(now + SLAVE_CLOCK_OFFSET);
+        f();
+        set_time(now);
+    }
+
+    void expect_event(size_t index, uint8_t row, uint8_t col, bool pressed, uint16_t time) {
+        ASSERT_LT(index, events.size());
+        EXPECT_EQ(events[index].row, row);
+        EXPECT_EQ(events[index].col, col);
+        EXPECT_EQ(events[index].pressed, pressed);
+        EXPECT_EQ(events[index].time, time | 1);
+    }
+};
+
+TEST_F(SplitEventTime, SlaveAgeBecomesMasterTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    uint16_t pressed_at = timer_read();
+    slave_change(0, true);
+    idle_for(20);
+    deliver();
+    run_one_scan_loop();
+
+    uint16_t released_at = timer_read();
+    slave_change(0, false);
+    idle_for(7);
+    deliver();
+    run_one_scan_loop();
+
+    ASSERT_EQ(events.size(), 2u);
+    expect_event(0, SLAVE_ROW, 0, true, pressed_at);
+    expect_event(1, SLAVE_ROW, 0, false, released_at);
+}
+
+TEST_F(SplitEventTime, NeverBeforeTheLastProcessedEvent) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // The slave key goes down first, but reaches the master after a master key
+    slave_change(1, true);
+    idle_for(5);
+    uint16_t master_at = timer_read();
+    press_key(0, 0);
+    run_one_scan_loop();
+    idle_for(3);
+    deliver();
+    run_one_scan_loop();
+
+    ASSERT_EQ(events.size(), 2u);
+    expect_event(0, 0, 0, true, master_at);
+    expect_event(1, SLAVE_ROW, 1, true, master_at);
+
+    slave_change(1, false);
+    release_key(0, 0);
+    deliver();
+    run_one_scan_loop();
+}
+
+TEST_F(SplitEventTime, OldChangesFallBackToArrivalTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    slave_change(2, true);
+    idle_for(SPLIT_EVENT_MAX_AGE + 45);
+    deliver();
+    uint16_t arrived_at = timer_read();
+    run_one_scan_loop();
+
+    ASSERT_EQ(events.size(), 1u);
+    expect_event(0, SLAVE_ROW, 2, true, arrived_at);
+
+    slave_change(2, false);
+    deliver();
+    run_one_scan_loop();
+}
+
+TEST_F(SplitEventTime, LastEventCountChangesKeepTheirTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // SPLIT_EVENT_COUNT changes, so the first one is still remembered
+    uint16_t first_at = timer_read();
+    slave_change(0, true);
+    idle_for(2);
+    slave_change(1, true);
+    idle_for(2);
+    slave_change(1, false);
+    idle_for(2);
+    uint16_t last_at = timer_read();
+    slave_change(2, true);
+    idle_for(10);
+    deliver();
+    run_one_scan_loop();
+
+    ASSERT_EQ(events.size(), 2u);
+    expect_event(0, SLAVE_ROW, 0, true, first_at);
+    expect_event(1, SLAVE_ROW, 2, true, last_at);
+
+    slave_change(0, false);
+    slave_change(2, false);
+    deliver();
+    run_one_scan_loop();
+}
+
+TEST_F(SplitEventTime, OverflowedChangeFallsBackToArrivalTime) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    // One change more than SPLIT_EVENT_COUNT pushes out the first one
+    slave_change(0, true);
+    idle_for(2);
+    slave_change(1, true);
+    idle_for(2);
+    slave_change(1, false);
+    idle_for(2);
+    slave_change(2, true);
+    idle_for(2);
+    slave_change(2, false);
+    idle_for(10);
+    deliver();
+    uint16_t arrived_at = timer_read();
+    run_one_scan_loop();
+
+    ASSERT_EQ(events.size(), 1u);
+    expect_event(0, SLAVE_ROW, 0, true, arrived_at);
+
+    slave_change(0, false);
+    deliver();
+    run_one_scan_loop();
+}
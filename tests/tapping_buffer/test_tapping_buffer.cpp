@@ -0,0 +1,97 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+
+using testing::_;
+using testing::InSequence;
+
+class TappingBuffer : public TestFixture {
+   protected:
+    void SetUp() override { tapping_stats_reset(); }
+};
+
+TEST_F(TappingBuffer, OverflowHoldsTapKeyInsteadOfDroppingKeys) {
+    TestDriver driver;
+    InSequence s;
+
+    // Four events typed while SFT_T(KC_A) is undecided, one more than fit
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    press_key(2, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_C)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+
+    tapping_stats_t stats = tapping_get_stats();
+    EXPECT_EQ(stats.overflows, 1);
+    EXPECT_EQ(stats.max_waiting, WAITING_BUFFER_SIZE - 1);
+    EXPECT_EQ(stats.resolutions, 1);
+}
+
+TEST_F(TappingBuffer, TapLatencyIsRecorded) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+
+    tapping_stats_t stats = tapping_get_stats();
+    // Key event times are only accurate to 2ms
+    EXPECT_EQ(stats.resolutions, 1);
+    EXPECT_NEAR(stats.max_latency, 50, 1);
+    EXPECT_EQ(stats.total_latency, stats.max_latency);
+    EXPECT_EQ(stats.overflows, 0);
+}
+
+TEST_F(TappingBuffer, HoldLatencyIsTheTappingTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    idle_for(TAPPING_TERM + 1);
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+
+    tapping_stats_t stats = tapping_get_stats();
+    EXPECT_EQ(stats.resolutions, 1);
+    EXPECT_NEAR(stats.max_latency, TAPPING_TERM, 1);
+}
@@ -66,6 +66,11 @@ ifeq ($(strip $(KEYBOARD_SHARED_EP)), yes)
     MOUSE_SHARED_EP = yes
 endif
 
+ifeq ($(strip $(PROFILER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/profiler.c
+    TMK_COMMON_DEFS += -DPROFILER_ENABLE
+endif
+
 ifeq ($(strip $(MOUSEKEY_ENABLE)), yes)
     TMK_COMMON_SRC += $(COMMON_DIR)/mousekey.c
     TMK_COMMON_DEFS += -DMOUSEKEY_ENABLE
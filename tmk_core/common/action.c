@@ -115,9 +115,13 @@ void action_exec(keyevent_t event) {
 #endif
 
 #ifndef NO_ACTION_TAPPING
-    action_tapping_process(record);
+    if (IS_NOEVENT(record.event) || pre_process_record_quantum(&record)) {
+        action_tapping_process(record);
+    }
 #else
-    process_record(&record);
+    if (IS_NOEVENT(record.event) || pre_process_record_quantum(&record)) {
+        process_record(&record);
+    }
     if (!IS_NOEVENT(record.event)) {
         dprint("processed: ");
         debug_record(record);
@@ -162,6 +166,8 @@ void process_record_nocache(keyrecord_t *record) {
 void process_record_nocache(keyrecord_t *record) { process_record(record); }
 #endif
 
+__attribute__((weak)) bool pre_process_record_quantum(keyrecord_t *record) { return true; }
+
 __attribute__((weak)) bool process_record_quantum(keyrecord_t *record) { return true; }
 
 __attribute__((weak)) void post_process_record_quantum(keyrecord_t *record) {}
@@ -274,6 +280,10 @@ void process_action(keyrecord_t *record, action_t action) {
         case ACT_LMODS:
         case ACT_RMODS: {
             uint8_t mods = (action.kind.id == ACT_LMODS) ? action.key.mods : action.key.mods << 4;
+#ifdef KEYBOARD_REPORT_COALESCE
+            // a plain key or modifier sends a single report, so it can be merged with the rest of the scan
+            keyboard_report_batch_allow(!mods && (action.key.code < KC_LOCKING_CAPS || action.key.code > KC_LOCKING_SCROLL));
+#endif
             if (event.pressed) {
                 if (mods) {
                     if (IS_MOD(action.key.code) || action.key.code == KC_NO) {
@@ -298,6 +308,9 @@ void process_action(keyrecord_t *record, action_t action) {
                     send_keyboard_report();
                 }
             }
+#ifdef KEYBOARD_REPORT_COALESCE
+            keyboard_report_batch_allow(false);
+#endif
         } break;
 #ifndef NO_ACTION_TAPPING
         case ACT_LMODS_TAP:
@@ -68,6 +68,7 @@ const macro_t *action_get_macro(keyrecord_t *record, uint8_t id, uint8_t opt);
 void action_function(keyrecord_t *record, uint8_t id, uint8_t opt);
 
 /* keyboard-specific key event (pre)processing */
+bool pre_process_record_quantum(keyrecord_t *record);
 bool process_record_quantum(keyrecord_t *record);
 
 /* Utilities for actions.  */
@@ -5,6 +5,9 @@
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#ifdef TAPPING_STATS
+#    include "print.h"
+#endif
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -35,14 +38,37 @@ __attribute__((weak)) bool get_tapping_force_hold(uint16_t keycode, keyrecord_t
 __attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) { return false; }
 #    endif
 
+#    if WAITING_BUFFER_SIZE < 2 || WAITING_BUFFER_SIZE > 255
+#        error "WAITING_BUFFER_SIZE must be between 2 and 255"
+#    endif
+
 static keyrecord_t tapping_key                         = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t     waiting_buffer_head                 = 0;
 static uint8_t     waiting_buffer_tail                 = 0;
 
+#    ifdef TAPPING_STATS
+static tapping_stats_t tapping_stats = {};
+
+static void tapping_key_resolved(void) {
+    uint16_t latency = timer_elapsed(tapping_key.event.time);
+    tapping_stats.resolutions++;
+    tapping_stats.total_latency += latency;
+    if (tapping_stats.max_latency < latency) {
+        tapping_stats.max_latency = latency;
+    }
+}
+#    else
+#        define tapping_key_resolved()
+#    endif
+
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
 static void waiting_buffer_clear(void);
+static void waiting_buffer_process(bool debug_header);
+#    if WAITING_BUFFER_OVERFLOW == WAITING_BUFFER_OVERFLOW_RESOLVE
+static bool waiting_buffer_make_room(void);
+#    endif
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
 static void waiting_buffer_scan_tap(void);
@@ -60,8 +86,16 @@ void action_tapping_process(keyrecord_t record) {
             debug_record(record);
             debug("\n");
         }
-    } else {
-        if (!waiting_buffer_enq(record)) {
+    } else if (!waiting_buffer_enq(record)) {
+#    ifdef TAPPING_STATS
+        tapping_stats.overflows++;
+#    endif
+#    if WAITING_BUFFER_OVERFLOW == WAITING_BUFFER_OVERFLOW_RESOLVE
+        if (waiting_buffer_make_room()) {
+            waiting_buffer_enq(record);
+        } else
+#    endif
+        {
             // clear all in case of overflow.
             debug("OVERFLOW: CLEAR ALL STATES\n");
             clear_keyboard();
@@ -70,8 +104,18 @@ void action_tapping_process(keyrecord_t record) {
         }
     }
 
-    // process waiting_buffer
-    if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
+    waiting_buffer_process(!IS_NOEVENT(record.event));
+    if (!IS_NOEVENT(record.event)) {
+        debug("\n");
+    }
+}
+
+/** \brief Process waiting buffer
+ *
+ * Processes waiting events in order, until one has to wait for the tapping key again.
+ */
+static void waiting_buffer_process(bool debug_header) {
+    if (debug_header && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
     for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
@@ -85,10 +129,32 @@ void action_tapping_process(keyrecord_t record) {
             break;
         }
     }
-    if (!IS_NOEVENT(record.event)) {
-        debug("\n");
+}
+
+#    if WAITING_BUFFER_OVERFLOW == WAITING_BUFFER_OVERFLOW_RESOLVE
+/** \brief Make room in waiting buffer
+ *
+ * Decides an undecided tapping key as held, as if TAPPING_TERM had run out,
+ * and processes the events that were waiting on it. Returns false if the
+ * buffer is still full, which leaves clearing everything as the last resort.
+ */
+static bool waiting_buffer_make_room(void) {
+    for (uint8_t attempt = 0; attempt < WAITING_BUFFER_SIZE; attempt++) {
+        if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+            debug("Tapping: End. Waiting buffer full, hold.\n");
+            tapping_key_resolved();
+            process_record(&tapping_key);
+            tapping_key = (keyrecord_t){};
+            debug_tapping_key();
+        }
+        waiting_buffer_process(true);
+        if ((waiting_buffer_head + 1) % WAITING_BUFFER_SIZE != waiting_buffer_tail) {
+            return true;
+        }
     }
+    return false;
 }
+#    endif
 
 /** \brief Tapping
  *
@@ -106,6 +172,7 @@ bool process_tapping(keyrecord_t *keyp) {
                 if (IS_TAPPING_KEY(event.key) && !event.pressed) {
                     // first tap!
                     debug("Tapping: First tap(0->1).\n");
+                    tapping_key_resolved();
                     tapping_key.tap.count = 1;
                     debug_tapping_key();
                     process_record(&tapping_key);
@@ -129,6 +196,7 @@ bool process_tapping(keyrecord_t *keyp) {
 #        endif
                     IS_RELEASED(event) && waiting_buffer_typed(event)) {
                     debug("Tapping: End. No tap. Interfered by typing key\n");
+                    tapping_key_resolved();
                     process_record(&tapping_key);
                     tapping_key = (keyrecord_t){};
                     debug_tapping_key();
@@ -206,6 +274,7 @@ bool process_tapping(keyrecord_t *keyp) {
                 debug("Tapping: End. Timeout. Not tap(0): ");
                 debug_event(event);
                 debug("\n");
+                tapping_key_resolved();
                 process_record(&tapping_key);
                 tapping_key = (keyrecord_t){};
                 debug_tapping_key();
@@ -327,6 +396,13 @@ bool waiting_buffer_enq(keyrecord_t record) {
     waiting_buffer[waiting_buffer_head] = record;
     waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
 
+#    ifdef TAPPING_STATS
+    uint8_t waiting = (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+    if (tapping_stats.max_waiting < waiting) {
+        tapping_stats.max_waiting = waiting;
+    }
+#    endif
+
     debug("waiting_buffer_enq: ");
     debug_waiting_buffer();
     return true;
@@ -377,6 +453,7 @@ void waiting_buffer_scan_tap(void) {
 
     for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
         if (IS_TAPPING_KEY(waiting_buffer[i].event.key) && !waiting_buffer[i].event.pressed && WITHIN_TAPPING_TERM(waiting_buffer[i].event)) {
+            tapping_key_resolved();
             tapping_key.tap.count       = 1;
             waiting_buffer[i].tap.count = 1;
             process_record(&tapping_key);
@@ -390,6 +467,22 @@ void waiting_buffer_scan_tap(void) {
     }
 }
 
+#    ifdef TAPPING_STATS
+tapping_stats_t tapping_get_stats(void) { return tapping_stats; }
+
+void tapping_stats_reset(void) { tapping_stats = (tapping_stats_t){}; }
+
+/** \brief Tapping stats print
+ *
+ * Shown on the debug console with the Magic status command.
+ */
+void tapping_stats_print(void) {
+#        ifndef NO_PRINT
+    xprintf("tapping: resolutions %u, latency avg %u max %u ms, waiting max %u/%u, overflows %u\n", tapping_stats.resolutions, tapping_stats.resolutions ? (uint16_t)(tapping_stats.total_latency / tapping_stats.resolutions) : 0, tapping_stats.max_latency, tapping_stats.max_waiting, WAITING_BUFFER_SIZE - 1, tapping_stats.overflows);
+#        endif
+}
+#    endif
+
 /** \brief Tapping key debug print
  *
  * FIXME: Needs docs
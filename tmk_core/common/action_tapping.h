@@ -27,7 +27,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define TAPPING_TOGGLE 5
 #endif
 
-#define WAITING_BUFFER_SIZE 8
+/* events held back while a tap key is undecided */
+#ifndef WAITING_BUFFER_SIZE
+#    define WAITING_BUFFER_SIZE 8
+#endif
+
+/* what to do when the waiting buffer is full */
+#define WAITING_BUFFER_OVERFLOW_CLEAR 0    // drop every waiting event and clear the keyboard
+#define WAITING_BUFFER_OVERFLOW_RESOLVE 1  // decide the tap key as held, then process waiting events
+#ifndef WAITING_BUFFER_OVERFLOW
+#    define WAITING_BUFFER_OVERFLOW WAITING_BUFFER_OVERFLOW_RESOLVE
+#endif
 
 #ifndef NO_ACTION_TAPPING
 uint16_t get_event_keycode(keyevent_t event, bool update_layer_cache);
@@ -38,4 +48,18 @@ bool     get_permissive_hold(uint16_t keycode, keyrecord_t *record);
 bool     get_ignore_mod_tap_interrupt(uint16_t keycode, keyrecord_t *record);
 bool     get_tapping_force_hold(uint16_t keycode, keyrecord_t *record);
 bool     get_retro_tapping(uint16_t keycode, keyrecord_t *record);
+
+#    ifdef TAPPING_STATS
+typedef struct {
+    uint16_t overflows;      // events that found the waiting buffer full
+    uint8_t  max_waiting;    // most events waiting at once
+    uint16_t resolutions;    // tap keys decided as tapped or held
+    uint16_t max_latency;    // longest time from a tap key press to its decision, in ms
+    uint32_t total_latency;  // of all resolutions, in ms
+} tapping_stats_t;
+
+tapping_stats_t tapping_get_stats(void);
+void            tapping_stats_reset(void);
+void            tapping_stats_print(void);
+#    endif
 #endif
@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_layer.h"
 #include "timer.h"
 #include "keycode_config.h"
+#ifdef KEYBOARD_REPORT_COALESCE
+#    include <string.h>
+#endif
 
 extern keymap_config_t keymap_config;
 
@@ -184,6 +187,79 @@ void clear_oneshot_layer_state(oneshot_fullfillment_t state) {
 bool is_oneshot_layer_active(void) { return get_oneshot_layer_state(); }
 #endif
 
+#ifdef KEYBOARD_REPORT_COALESCE
+static report_keyboard_t sent_report;
+static report_keyboard_t pending_report;
+static bool              report_batch_active = false;
+static bool              report_batch_allow  = false;
+static bool              report_pending      = false;
+
+/** \brief Check whether a report would undo a change still held in the pending report
+ *
+ * Merging such a report would hide a press or release from the host, so the pending
+ * report has to go out first.
+ */
+static bool report_reverses_pending(report_keyboard_t *report) {
+    uint8_t added   = pending_report.mods & ~sent_report.mods;
+    uint8_t removed = sent_report.mods & ~pending_report.mods;
+    if ((added & ~report->mods) || (removed & report->mods)) {
+        return true;
+    }
+#    ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            added   = pending_report.nkro.bits[i] & ~sent_report.nkro.bits[i];
+            removed = sent_report.nkro.bits[i] & ~pending_report.nkro.bits[i];
+            if ((added & ~report->nkro.bits[i]) || (removed & report->nkro.bits[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+#    endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t key = pending_report.keys[i];
+        if (key != KC_NO && !is_key_pressed(&sent_report, key) && !is_key_pressed(report, key)) {
+            return true;
+        }
+        key = sent_report.keys[i];
+        if (!is_key_pressed(&pending_report, key) && is_key_pressed(report, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void flush_pending_report(void) {
+    if (report_pending) {
+        report_pending = false;
+        memcpy(&sent_report, &pending_report, sizeof(report_keyboard_t));
+        host_keyboard_send(&sent_report);
+    }
+}
+
+/** \brief Start collecting keyboard reports
+ *
+ * While a batch is open, reports produced by plain key events (see keyboard_report_batch_allow())
+ * are merged and only the final state is sent by keyboard_report_batch_end(). Any other report
+ * sends the merged state first, so mod-before-key, tap and macro ordering is preserved.
+ */
+void keyboard_report_batch_begin(void) { report_batch_active = true; }
+
+/** \brief Allow or forbid merging of the reports that follow
+ *
+ * Only set this around actions that send exactly one report and never wait.
+ */
+void keyboard_report_batch_allow(bool allow) { report_batch_allow = allow; }
+
+/** \brief Send the merged report of the current batch, if any
+ */
+void keyboard_report_batch_end(void) {
+    report_batch_active = false;
+    flush_pending_report();
+}
+#endif
+
 /** \brief Send keyboard report
  *
  * FIXME: needs doc
@@ -206,6 +282,18 @@ void send_keyboard_report(void) {
         }
     }
 
+#endif
+#ifdef KEYBOARD_REPORT_COALESCE
+    if (report_batch_active && report_batch_allow) {
+        if (report_pending && report_reverses_pending(keyboard_report)) {
+            flush_pending_report();
+        }
+        memcpy(&pending_report, keyboard_report, sizeof(report_keyboard_t));
+        report_pending = true;
+        return;
+    }
+    flush_pending_report();
+    memcpy(&sent_report, keyboard_report, sizeof(report_keyboard_t));
 #endif
     host_keyboard_send(keyboard_report);
 }
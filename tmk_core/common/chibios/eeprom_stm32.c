@@ -17,6 +17,7 @@
  */
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <string.h>
 #include "eeprom_stm32.h"
 /*****************************************************************************
@@ -24,138 +25,332 @@
  * the functionality use the EEPROM_Init() function. Be sure that by reprogramming
  * of the controller just affected pages will be deleted. In other case the non
  * volatile data will be lost.
+ *
+ * Reads are served from a RAM copy of the emulated EEPROM. Writes update the
+ * RAM copy and append an (address, value) record to the log of the active bank,
+ * so a write never erases flash. Erasing and compacting into the spare bank is
+ * spread over EEPROM_Task() calls, and only done inline when the log is full.
  ******************************************************************************/
 
 /* Private macro -------------------------------------------------------------*/
+#define FEE_SNAPSHOT_WORDS (FEE_DENSITY_BYTES / 2)
+#define FEE_BANK_ADDRESS(bank) (FEE_PAGE_BASE_ADDRESS + (bank)*FEE_BANK_SIZE)
+
 /* Private variables ---------------------------------------------------------*/
+static uint8_t  DataBuf[FEE_DENSITY_BYTES];
+static uint8_t  ActiveBank;
+static uint16_t Sequence;
+static uint16_t LogCount;     // log records in use in the active bank
+static uint8_t  SpareErased;  // pages of the spare bank already erased
+static bool     Compacting;
+static uint16_t CompactPos;  // snapshot half words already copied into the spare bank
+
 /* Functions -----------------------------------------------------------------*/
 
-uint8_t DataBuf[FEE_PAGE_SIZE];
+static uint16_t FEE_ReadHalfWord(uint32_t Address) {
+#ifdef EEPROM_TEST_HARNESS
+    return FLASH_ReadHalfWord(Address);
+#else
+    return *(__IO uint16_t *)Address;
+#endif
+}
+
+/*****************************************************************************
+ *  Erase the next page of the spare bank, returns true once it is all erased
+ ******************************************************************************/
+static bool FEE_EraseSparePage(void) {
+    if (SpareErased < FEE_BANK_PAGES) {
+        FLASH_ErasePage(FEE_BANK_ADDRESS(ActiveBank ^ 1) + (SpareErased * FEE_PAGE_SIZE));
+        SpareErased++;
+    }
+    return SpareErased == FEE_BANK_PAGES;
+}
+
+static bool FEE_IsSpareErased(void) {
+    uint32_t base = FEE_BANK_ADDRESS(ActiveBank ^ 1);
+    for (uint32_t i = 0; i < FEE_BANK_SIZE; i += 2) {
+        if (FEE_ReadHalfWord(base + i) != FEE_EMPTY_WORD) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /*****************************************************************************
- *  Delete Flash Space used for user Data, deletes the whole space between
- *  RW_PAGE_BASE_ADDRESS and the last uC Flash Page
+ *  Copy up to Count half words of the RAM copy into the spare bank snapshot
+ ******************************************************************************/
+static void FEE_CompactStep(uint16_t Count) {
+    uint32_t snapshot = FEE_BANK_ADDRESS(ActiveBank ^ 1) + FEE_SNAPSHOT_OFFSET;
+    while (Count-- && CompactPos < FEE_SNAPSHOT_WORDS) {
+        uint16_t data = DataBuf[CompactPos * 2] | (DataBuf[CompactPos * 2 + 1] << 8);
+        // erased flash already reads back as 0xFFFF
+        if (data != FEE_EMPTY_WORD) {
+            FLASH_ProgramHalfWord(snapshot + (CompactPos * 2), data);
+        }
+        CompactPos++;
+    }
+}
+
+/*****************************************************************************
+ *  Complete the snapshot, log the bytes that changed while it was being
+ *  copied, then commit the spare bank by writing its header last.
+ ******************************************************************************/
+static void FEE_CompactFinish(void) {
+    uint8_t  bank  = ActiveBank ^ 1;
+    uint32_t base  = FEE_BANK_ADDRESS(bank);
+    uint16_t count = 0;
+
+    if (!Compacting) {
+        Compacting = true;
+        CompactPos = 0;
+    }
+    FEE_CompactStep(FEE_SNAPSHOT_WORDS);
+
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES && count < FEE_LOG_RECORDS; i++) {
+        uint16_t data = FEE_ReadHalfWord(base + FEE_SNAPSHOT_OFFSET + (i & ~1));
+        uint8_t  byte = (i & 1) ? (data >> 8) : (data & 0xFF);
+        if (byte != DataBuf[i]) {
+            uint32_t record = base + FEE_LOG_OFFSET + (count * 4);
+            FLASH_ProgramHalfWord(record, i);
+            FLASH_ProgramHalfWord(record + 2, DataBuf[i]);
+            count++;
+        }
+    }
+
+    Sequence++;
+    // a migration marks the bank with its sequence before it is complete
+    if (FEE_ReadHalfWord(base + 2) != Sequence) {
+        FLASH_ProgramHalfWord(base + 2, Sequence);
+    }
+    FLASH_ProgramHalfWord(base, FEE_BANK_MAGIC);
+
+    ActiveBank  = bank;
+    LogCount    = count;
+    SpareErased = 0;
+    Compacting  = false;
+    CompactPos  = 0;
+}
+
+/*****************************************************************************
+ *  Build bank 0 from the previous page-rewriting layout. The first
+ *  FEE_MIGRATE_PAGES pages of bank 0 are written and marked before the legacy
+ *  pages under the rest of it are erased, and a reset after the mark resumes
+ *  from them, so the legacy bytes are never only held in RAM.
+ ******************************************************************************/
+static void FEE_Migrate(void) {
+    uint32_t base   = FEE_BANK_ADDRESS(0);
+    bool     resume = FEE_ReadHalfWord(base) == FEE_EMPTY_WORD && FEE_ReadHalfWord(base + 2) == FEE_MIGRATE_SEQUENCE;
+
+    memset(DataBuf, 0xFF, sizeof(DataBuf));
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES && i < FEE_LEGACY_BYTES; i++) {
+        DataBuf[i] = FEE_ReadHalfWord(FEE_LEGACY_BASE_ADDRESS + FEE_ADDR_OFFSET(i)) & 0xFF;
+    }
+
+    ActiveBank  = 1;
+    Sequence    = FEE_MIGRATE_SEQUENCE - 1;
+    SpareErased = 0;
+    Compacting  = true;
+    CompactPos  = 0;
+
+    if (resume) {
+        // the legacy pages under the rest of bank 0 may be erased already
+        for (uint16_t i = 0; i < FEE_MIGRATE_WORDS; i++) {
+            uint16_t data      = FEE_ReadHalfWord(base + FEE_SNAPSHOT_OFFSET + (i * 2));
+            DataBuf[i * 2]     = data & 0xFF;
+            DataBuf[i * 2 + 1] = data >> 8;
+        }
+        SpareErased = FEE_MIGRATE_PAGES;
+        CompactPos  = FEE_MIGRATE_WORDS;
+    } else {
+        while (SpareErased < FEE_MIGRATE_PAGES) {
+            FEE_EraseSparePage();
+        }
+        FEE_CompactStep(FEE_MIGRATE_WORDS);
+        FLASH_ProgramHalfWord(base + 2, FEE_MIGRATE_SEQUENCE);
+    }
+
+    while (!FEE_EraseSparePage()) {
+    }
+    FEE_CompactFinish();
+}
+
+/*****************************************************************************
+ *  Find the newest valid bank and rebuild the RAM copy from its snapshot and
+ *  log. Data left by the previous page-rewriting layout is migrated.
  ******************************************************************************/
 uint16_t EEPROM_Init(void) {
+    int8_t bank = -1;
+
+#ifndef EEPROM_TEST_HARNESS
+    // for the link time check in eeprom_stm32.ld
+    __asm__ volatile(".global __eeprom_emu_base__\n\t.set __eeprom_emu_base__, %c0" ::"i"(FEE_PAGE_BASE_ADDRESS));
+#endif
+
     // unlock flash
     FLASH_Unlock();
 
     // Clear Flags
     // FLASH_ClearFlag(FLASH_SR_EOP|FLASH_SR_PGERR|FLASH_SR_WRPERR);
 
+    Compacting = false;
+    CompactPos = 0;
+    Sequence   = 0;
+
+    for (uint8_t i = 0; i < 2; i++) {
+        uint32_t base = FEE_BANK_ADDRESS(i);
+        if (FEE_ReadHalfWord(base) == FEE_BANK_MAGIC) {
+            uint16_t sequence = FEE_ReadHalfWord(base + 2);
+            if (bank < 0 || (int16_t)(sequence - Sequence) > 0) {
+                bank     = i;
+                Sequence = sequence;
+            }
+        }
+    }
+
+    if (bank < 0) {
+        FEE_Migrate();
+        return FEE_DENSITY_BYTES;
+    }
+
+    ActiveBank = bank;
+    uint32_t base = FEE_BANK_ADDRESS(ActiveBank);
+    for (uint16_t i = 0; i < FEE_SNAPSHOT_WORDS; i++) {
+        uint16_t data      = FEE_ReadHalfWord(base + FEE_SNAPSHOT_OFFSET + (i * 2));
+        DataBuf[i * 2]     = data & 0xFF;
+        DataBuf[i * 2 + 1] = data >> 8;
+    }
+
+    for (LogCount = 0; LogCount < FEE_LOG_RECORDS; LogCount++) {
+        uint32_t record  = base + FEE_LOG_OFFSET + (LogCount * 4);
+        uint16_t address = FEE_ReadHalfWord(record);
+        uint16_t value   = FEE_ReadHalfWord(record + 2);
+        if (address == FEE_EMPTY_WORD) {
+            break;
+        }
+        // skip records torn by a reset between the two half words
+        if (address < FEE_DENSITY_BYTES && value != FEE_EMPTY_WORD) {
+            DataBuf[address] = value;
+        }
+    }
+
+    SpareErased = FEE_IsSpareErased() ? FEE_BANK_PAGES : 0;
+
     return FEE_DENSITY_BYTES;
 }
 /*****************************************************************************
- *  Erase the whole reserved Flash Space used for user Data
+ *  Clear the emulated EEPROM. Only the spare bank is erased here, the
+ *  previously active bank is erased later by EEPROM_Task().
  ******************************************************************************/
 void EEPROM_Erase(void) {
-    int page_num = 0;
-
-    // delete all pages from specified start page to the last page
-    do {
-        FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page_num * FEE_PAGE_SIZE));
-        page_num++;
-    } while (page_num < FEE_DENSITY_PAGES);
+    memset(DataBuf, 0xFF, sizeof(DataBuf));
+    // a compaction in progress has already programmed part of the spare bank
+    Compacting  = false;
+    CompactPos  = 0;
+    SpareErased = 0;
+    while (!FEE_EraseSparePage()) {
+    }
+    FEE_CompactFinish();
 }
 /*****************************************************************************
- *  Writes once data byte to flash on specified address. If a byte is already
- *  written, the whole page must be copied to a buffer, the byte changed and
- *  the manipulated buffer written after PageErase.
+ *  Background maintenance, call from the main loop. Each call does at most one
+ *  page erase or FEE_COMPACT_CHUNK half word writes.
+ ******************************************************************************/
+void EEPROM_Task(void) {
+    if (!FEE_EraseSparePage()) {
+        return;
+    }
+    if (!Compacting && LogCount >= FEE_COMPACT_THRESHOLD) {
+        Compacting = true;
+        CompactPos = 0;
+    }
+    if (Compacting) {
+        FEE_CompactStep(FEE_COMPACT_CHUNK);
+        if (CompactPos >= FEE_SNAPSHOT_WORDS) {
+            FEE_CompactFinish();
+        }
+    }
+}
+/*****************************************************************************
+ *  Writes once data byte to flash on specified address. The byte is appended
+ *  to the write log; only a full log forces an inline compaction.
  *******************************************************************************/
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte) {
-    FLASH_Status FlashStatus = FLASH_COMPLETE;
-
-    uint32_t page;
-    int      i;
-
-    // exit if desired address is above the limit (e.G. under 2048 Bytes for 4 pages)
-    if (Address > FEE_DENSITY_BYTES) {
+    // exit if desired address is above the limit
+    if (Address >= FEE_DENSITY_BYTES) {
         return 0;
     }
 
-    // calculate which page is affected (Pagenum1/Pagenum2...PagenumN)
-    page = FEE_ADDR_OFFSET(Address) / FEE_PAGE_SIZE;
-
-    // if current data is 0xFF, the byte is empty, just overwrite with the new one
-    if ((*(__IO uint16_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) == FEE_EMPTY_WORD) {
-        FlashStatus = FLASH_ProgramHalfWord(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address), (uint16_t)(0x00FF & DataByte));
-    } else {
-        // Copy Page to a buffer
-        memcpy(DataBuf, (uint8_t *)FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE), FEE_PAGE_SIZE);  // !!! Calculate base address for the desired page
-
-        // check if new data is differ to current data, return if not, proceed if yes
-        if (DataByte == *(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address))) {
-            return 0;
-        }
-
-        // manipulate desired data byte in temp data array if new byte is differ to the current
-        DataBuf[FEE_ADDR_OFFSET(Address) % FEE_PAGE_SIZE] = DataByte;
-
-        // Erase Page
-        FlashStatus = FLASH_ErasePage(FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE));
+    // check if new data is differ to current data, return if not, proceed if yes
+    if (DataBuf[Address] == DataByte) {
+        return FLASH_COMPLETE;
+    }
+    DataBuf[Address] = DataByte;
 
-        // Write new data (whole page) to flash if data has been changed
-        for (i = 0; i < (FEE_PAGE_SIZE / 2); i++) {
-            if ((__IO uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]) != 0xFFFF) {
-                FlashStatus = FLASH_ProgramHalfWord((FEE_PAGE_BASE_ADDRESS + (page * FEE_PAGE_SIZE)) + (i * 2), (uint16_t)(0xFF00 | DataBuf[FEE_ADDR_OFFSET(i)]));
-            }
+    if (LogCount >= FEE_LOG_RECORDS) {
+        // the new value is picked up by the snapshot
+        while (!FEE_EraseSparePage()) {
         }
+        FEE_CompactFinish();
+        return FLASH_COMPLETE;
     }
-    return FlashStatus;
+
+    uint32_t record = FEE_BANK_ADDRESS(ActiveBank) + FEE_LOG_OFFSET + (LogCount * 4);
+    LogCount++;
+    FLASH_ProgramHalfWord(record, Address);
+    return FLASH_ProgramHalfWord(record + 2, DataByte);
 }
 /*****************************************************************************
  *  Read once data byte from a specified address.
  *******************************************************************************/
 uint8_t EEPROM_ReadDataByte(uint16_t Address) {
-    uint8_t DataByte = 0xFF;
-
-    // Get Byte from specified address
-    DataByte = (*(__IO uint8_t *)(FEE_PAGE_BASE_ADDRESS + FEE_ADDR_OFFSET(Address)));
-
-    return DataByte;
+    if (Address >= FEE_DENSITY_BYTES) {
+        return 0xFF;
+    }
+    return DataBuf[Address];
 }
 
 /*****************************************************************************
  *  Wrap library in AVR style functions.
  *******************************************************************************/
 uint8_t eeprom_read_byte(const uint8_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p);
 }
 
 void eeprom_write_byte(uint8_t *Address, uint8_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, Value);
 }
 
 void eeprom_update_byte(uint8_t *Address, uint8_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, Value);
 }
 
 uint16_t eeprom_read_word(const uint16_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8);
 }
 
 void eeprom_write_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
 }
 
 void eeprom_update_word(uint16_t *Address, uint16_t Value) {
-    uint16_t p = (uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
 }
 
 uint32_t eeprom_read_dword(const uint32_t *Address) {
-    const uint16_t p = (const uint32_t)Address;
+    const uint16_t p = (uintptr_t)Address;
     return EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
 }
 
 void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p = (const uint32_t)Address;
+    uint16_t p = (uintptr_t)Address;
     EEPROM_WriteDataByte(p, (uint8_t)Value);
     EEPROM_WriteDataByte(p + 1, (uint8_t)(Value >> 8));
     EEPROM_WriteDataByte(p + 2, (uint8_t)(Value >> 16));
@@ -163,7 +358,7 @@ void eeprom_write_dword(uint32_t *Address, uint32_t Value) {
 }
 
 void eeprom_update_dword(uint32_t *Address, uint32_t Value) {
-    uint16_t p             = (const uint32_t)Address;
+    uint16_t p             = (uintptr_t)Address;
     uint32_t existingValue = EEPROM_ReadDataByte(p) | (EEPROM_ReadDataByte(p + 1) << 8) | (EEPROM_ReadDataByte(p + 2) << 16) | (EEPROM_ReadDataByte(p + 3) << 24);
     if (Value != existingValue) {
         EEPROM_WriteDataByte(p, (uint8_t)Value);
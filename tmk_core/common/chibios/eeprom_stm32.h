@@ -17,14 +17,16 @@
  *
  * This library assumes 8-bit data locations. To add a new MCU, please provide the flash
  * page size and the total flash size in Kb. The number of available pages must be a multiple
- * of 2. Only half of the pages account for the total EEPROM size.
+ * of 2. The pages are split into two banks, only one of which is in use at any time.
  * This library also assumes that the pages are not used by the firmware.
  */
 
 #pragma once
 
-#include <ch.h>
-#include <hal.h>
+#ifndef EEPROM_TEST_HARNESS
+#    include <ch.h>
+#    include <hal.h>
+#endif
 #include "flash_stm32.h"
 
 // HACK ALERT. This definition may not match your processor
@@ -41,13 +43,15 @@
 #    error "not implemented."
 #endif
 
-#ifndef EEPROM_PAGE_SIZE
+#ifndef FEE_PAGE_SIZE
 #    if defined(MCU_STM32F103RB) || defined(MCU_STM32F042K6)
-#        define FEE_PAGE_SIZE (uint16_t)0x400  // Page size = 1KByte
-#        define FEE_DENSITY_PAGES 2            // How many pages are used
+#        define FEE_PAGE_SIZE 0x400  // Page size = 1KByte
+#        define FEE_DENSITY_PAGES 4  // How many pages are used
+#        define FEE_LEGACY_PAGES 2   // How many pages the previous layout used
 #    elif defined(MCU_STM32F103ZE) || defined(MCU_STM32F103RE) || defined(MCU_STM32F103RD) || defined(MCU_STM32F303CC) || defined(MCU_STM32F072CB)
-#        define FEE_PAGE_SIZE (uint16_t)0x800  // Page size = 2KByte
-#        define FEE_DENSITY_PAGES 4            // How many pages are used
+#        define FEE_PAGE_SIZE 0x800  // Page size = 2KByte
+#        define FEE_DENSITY_PAGES 6  // How many pages are used
+#        define FEE_LEGACY_PAGES 4   // How many pages the previous layout used
 #    else
 #        error "No MCU type specified. Add something like -DMCU_STM32F103RB to your compiler arguments (probably in a Makefile)."
 #    endif
@@ -72,13 +76,73 @@
 // DONT CHANGE
 // Choose location for the first EEPROM Page address on the top of flash
 #define FEE_PAGE_BASE_ADDRESS ((uint32_t)(0x8000000 + FEE_MCU_FLASH_SIZE * 1024 - FEE_DENSITY_PAGES * FEE_PAGE_SIZE))
-#define FEE_DENSITY_BYTES ((FEE_PAGE_SIZE / 2) * FEE_DENSITY_PAGES - 1)
 #define FEE_LAST_PAGE_ADDRESS (FEE_PAGE_BASE_ADDRESS + (FEE_PAGE_SIZE * FEE_DENSITY_PAGES))
 #define FEE_EMPTY_WORD ((uint16_t)0xFFFF)
-#define FEE_ADDR_OFFSET(Address) (Address * 2)  // 1Byte per Word will be saved to preserve Flash
+#define FEE_ADDR_OFFSET(Address) (Address * 2)  // Legacy layout: 1Byte per Word, only read when migrating
+
+// The previous layout kept one byte per half word in the top FEE_LEGACY_PAGES pages
+#ifndef FEE_LEGACY_PAGES
+#    define FEE_LEGACY_PAGES FEE_DENSITY_PAGES
+#endif
+#define FEE_LEGACY_BASE_ADDRESS (FEE_LAST_PAGE_ADDRESS - FEE_LEGACY_PAGES * FEE_PAGE_SIZE)
+#define FEE_LEGACY_BYTES ((FEE_PAGE_SIZE / 2) * FEE_LEGACY_PAGES - 1)
+
+/* Each bank holds a header, a snapshot of the whole EEPROM and an append-only
+ * log of byte writes. When the log fills up, the RAM copy is compacted into
+ * the other bank, which is erased in the background by EEPROM_Task().
+ *
+ * | magic | sequence | snapshot (FEE_DENSITY_BYTES) | log: address, value, ... |
+ */
+#define FEE_BANK_PAGES (FEE_DENSITY_PAGES / 2)
+#define FEE_BANK_SIZE (FEE_PAGE_SIZE * FEE_BANK_PAGES)
+#define FEE_BANK_MAGIC ((uint16_t)0x51EE)
+#define FEE_HEADER_SIZE 4
+
+// Number of emulated bytes, at least as many as the previous layout had
+#ifndef FEE_DENSITY_BYTES
+#    define FEE_DENSITY_BYTES (FEE_LEGACY_BYTES + 1)
+#endif
+
+#if (FEE_DENSITY_BYTES % 2) != 0 || (FEE_HEADER_SIZE + FEE_DENSITY_BYTES + 4) > FEE_BANK_SIZE
+#    error "FEE_DENSITY_BYTES must be even and leave room for the write log"
+#endif
+
+#define FEE_SNAPSHOT_OFFSET FEE_HEADER_SIZE
+#define FEE_LOG_OFFSET (FEE_SNAPSHOT_OFFSET + FEE_DENSITY_BYTES)
+#define FEE_LOG_RECORDS ((FEE_BANK_SIZE - FEE_LOG_OFFSET) / 4)
+
+/* The legacy layout is migrated into bank 0. Its pages below the legacy pages
+ * are filled first and marked with the new sequence, so the legacy pages bank 0
+ * overlaps are only erased once the bytes they hold are safe. */
+#if (FEE_DENSITY_PAGES - FEE_LEGACY_PAGES) < FEE_BANK_PAGES
+#    define FEE_MIGRATE_PAGES (FEE_DENSITY_PAGES - FEE_LEGACY_PAGES)
+#else
+#    define FEE_MIGRATE_PAGES FEE_BANK_PAGES
+#endif
+#if (FEE_MIGRATE_PAGES * FEE_PAGE_SIZE - FEE_SNAPSHOT_OFFSET) < FEE_DENSITY_BYTES
+#    define FEE_MIGRATE_WORDS ((FEE_MIGRATE_PAGES * FEE_PAGE_SIZE - FEE_SNAPSHOT_OFFSET) / 2)
+#else
+#    define FEE_MIGRATE_WORDS (FEE_DENSITY_BYTES / 2)
+#endif
+#define FEE_MIGRATE_SEQUENCE 1
+
+#if FEE_MIGRATE_PAGES < 1 || (FEE_MIGRATE_WORDS * 2) < ((FEE_BANK_PAGES - FEE_MIGRATE_PAGES) * FEE_PAGE_SIZE / 2)
+#    error "Bank 0 overlaps more of the legacy pages than it can migrate safely, increase FEE_DENSITY_PAGES"
+#endif
+
+// Start compacting in the background once this many log records are in use
+#ifndef FEE_COMPACT_THRESHOLD
+#    define FEE_COMPACT_THRESHOLD (FEE_LOG_RECORDS * 3 / 4)
+#endif
+
+// Number of snapshot half words programmed per EEPROM_Task() call while compacting
+#ifndef FEE_COMPACT_CHUNK
+#    define FEE_COMPACT_CHUNK 32
+#endif
 
 // Use this function to initialize the functionality
 uint16_t EEPROM_Init(void);
 void     EEPROM_Erase(void);
+void     EEPROM_Task(void);
 uint16_t EEPROM_WriteDataByte(uint16_t Address, uint8_t DataByte);
 uint8_t  EEPROM_ReadDataByte(uint16_t Address);
@@ -22,8 +22,13 @@
 extern "C" {
 #endif
 
-#include <ch.h>
-#include <hal.h>
+#ifndef EEPROM_TEST_HARNESS
+#    include <ch.h>
+#    include <hal.h>
+#else
+#    include <stdint.h>
+#    define __IO volatile
+#endif
 
 typedef enum { FLASH_BUSY = 1, FLASH_ERROR_PG, FLASH_ERROR_WRP, FLASH_ERROR_OPT, FLASH_COMPLETE, FLASH_TIMEOUT, FLASH_BAD_ADDRESS } FLASH_Status;
 
@@ -33,6 +38,10 @@ FLASH_Status FLASH_WaitForLastOperation(uint32_t Timeout);
 FLASH_Status FLASH_ErasePage(uint32_t Page_Address);
 FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data);
 
+#ifdef EEPROM_TEST_HARNESS
+uint16_t FLASH_ReadHalfWord(uint32_t Address);
+#endif
+
 void FLASH_Unlock(void);
 void FLASH_Lock(void);
 void FLASH_ClearFlag(uint32_t FLASH_FLAG);
@@ -0,0 +1,207 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "flash_stm32_mock.h"
+}
+
+// Half words of the snapshot, more than FEE_LOG_RECORDS bytes but less than all of it
+#define FEE_SNAPSHOT_PROGRESS (FEE_LOG_RECORDS / 2 + FEE_COMPACT_CHUNK)
+
+class EepromStm32Test : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        flash_mock_reset();
+        EEPROM_Init();
+        flash_mock_erase_count   = 0;
+        flash_mock_program_count = 0;
+    }
+};
+
+TEST_F(EepromStm32Test, TestBlankEepromReadsErased) {
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        EXPECT_EQ(EEPROM_ReadDataByte(i), 0xFF);
+    }
+    EXPECT_EQ(EEPROM_ReadDataByte(FEE_DENSITY_BYTES), 0xFF);
+}
+
+TEST_F(EepromStm32Test, TestWritesSurviveReinit) {
+    EEPROM_WriteDataByte(0, 0x12);
+    EEPROM_WriteDataByte(1, 0x34);
+    EEPROM_WriteDataByte(FEE_DENSITY_BYTES - 1, 0x56);
+    EEPROM_WriteDataByte(1, 0x78);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataByte(0), 0x12);
+    EXPECT_EQ(EEPROM_ReadDataByte(1), 0x78);
+    EXPECT_EQ(EEPROM_ReadDataByte(FEE_DENSITY_BYTES - 1), 0x56);
+    EXPECT_EQ(EEPROM_ReadDataByte(2), 0xFF);
+}
+
+TEST_F(EepromStm32Test, TestUnchangedWriteDoesNotProgram) {
+    EEPROM_WriteDataByte(10, 0xAA);
+    uint32_t programs = flash_mock_program_count;
+    EEPROM_WriteDataByte(10, 0xAA);
+    EXPECT_EQ(flash_mock_program_count, programs);
+}
+
+TEST_F(EepromStm32Test, TestWritesDoNotErase) {
+    for (uint16_t i = 0; i < FEE_COMPACT_THRESHOLD; i++) {
+        EEPROM_WriteDataByte(i % FEE_DENSITY_BYTES, i);
+    }
+    EXPECT_EQ(flash_mock_erase_count, 0u);
+}
+
+TEST_F(EepromStm32Test, TestKeepsLegacyCapacity) {
+    EXPECT_GE(FEE_DENSITY_BYTES, FEE_LEGACY_BYTES);
+    EEPROM_WriteDataByte(FEE_LEGACY_BYTES - 1, 0x42);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataByte(FEE_LEGACY_BYTES - 1), 0x42);
+}
+
+TEST_F(EepromStm32Test, TestMigratesLegacyLayout) {
+    const uint32_t legacy = FEE_LEGACY_BASE_ADDRESS - FEE_PAGE_BASE_ADDRESS;
+    const uint16_t last   = FEE_LEGACY_BYTES - 1;
+    flash_mock_reset();
+    for (uint16_t i = 0; i < 16; i++) {
+        flash_mock[legacy + FEE_ADDR_OFFSET(i)]     = i + 1;
+        flash_mock[legacy + FEE_ADDR_OFFSET(i) + 1] = 0x00;
+    }
+    flash_mock[legacy + FEE_ADDR_OFFSET(last)]     = 0x5A;
+    flash_mock[legacy + FEE_ADDR_OFFSET(last) + 1] = 0x00;
+    EEPROM_Init();
+    for (uint16_t i = 0; i < 16; i++) {
+        EXPECT_EQ(EEPROM_ReadDataByte(i), i + 1);
+    }
+    EXPECT_EQ(EEPROM_ReadDataByte(16), 0xFF);
+    EXPECT_EQ(EEPROM_ReadDataByte(last), 0x5A);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataByte(15), 16);
+    EXPECT_EQ(EEPROM_ReadDataByte(last), 0x5A);
+}
+
+TEST_F(EepromStm32Test, TestMigrationSurvivesPowerLoss) {
+    const uint32_t legacy = FEE_LEGACY_BASE_ADDRESS - FEE_PAGE_BASE_ADDRESS;
+    // cut the power after every flash operation of the migration in turn
+    for (int32_t cut = 0;; cut++) {
+        flash_mock_reset();
+        for (uint16_t i = 0; i < FEE_LEGACY_BYTES; i++) {
+            flash_mock[legacy + FEE_ADDR_OFFSET(i)]     = i * 7 + 3;
+            flash_mock[legacy + FEE_ADDR_OFFSET(i) + 1] = 0x00;
+        }
+        flash_mock_power_loss = cut;
+        EEPROM_Init();
+        bool finished         = flash_mock_power_loss > 0;
+        flash_mock_power_loss = -1;
+
+        EEPROM_Init();
+        ASSERT_EQ(flash_mock_program_errors, 0u) << "power lost after " << cut;
+        for (uint16_t i = 0; i < FEE_LEGACY_BYTES; i++) {
+            ASSERT_EQ(EEPROM_ReadDataByte(i), (uint8_t)(i * 7 + 3)) << "power lost after " << cut << " at " << i;
+        }
+        if (finished) {
+            break;
+        }
+    }
+}
+
+TEST_F(EepromStm32Test, TestEraseClearsData) {
+    EEPROM_WriteDataByte(3, 0x33);
+    EEPROM_Erase();
+    EXPECT_EQ(EEPROM_ReadDataByte(3), 0xFF);
+    EEPROM_Init();
+    EXPECT_EQ(EEPROM_ReadDataByte(3), 0xFF);
+}
+
+TEST_F(EepromStm32Test, TestEraseDuringCompaction) {
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        EEPROM_WriteDataByte(i, 0x00);
+    }
+    // write until EEPROM_Task() starts copying the snapshot into the spare bank
+    uint16_t address = 0;
+    uint32_t programs;
+    do {
+        EEPROM_WriteDataByte(address++, 0x01);
+        programs = flash_mock_program_count;
+        EEPROM_Task();
+    } while (flash_mock_program_count == programs);
+    // leave more of the snapshot copied than the log could patch up
+    while (flash_mock_program_count - programs < FEE_SNAPSHOT_PROGRESS) {
+        EEPROM_Task();
+    }
+
+    EEPROM_Erase();
+    EXPECT_EQ(flash_mock_program_errors, 0u);
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        ASSERT_EQ(EEPROM_ReadDataByte(i), 0xFF);
+    }
+    EEPROM_Init();
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        ASSERT_EQ(EEPROM_ReadDataByte(i), 0xFF) << "at " << i;
+    }
+}
+
+TEST_F(EepromStm32Test, TestBackgroundCompactionKeepsData) {
+    uint8_t expected[FEE_DENSITY_BYTES];
+    memset(expected, 0xFF, sizeof(expected));
+    for (uint32_t i = 0; i < 5000; i++) {
+        uint16_t address = (i * 7) % FEE_DENSITY_BYTES;
+        uint8_t  value   = i * 13;
+        EEPROM_WriteDataByte(address, value);
+        expected[address] = value;
+        EEPROM_Task();
+    }
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        EXPECT_EQ(EEPROM_ReadDataByte(i), expected[i]);
+    }
+    EXPECT_EQ(flash_mock_program_errors, 0u);
+    EEPROM_Init();
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        EXPECT_EQ(EEPROM_ReadDataByte(i), expected[i]);
+    }
+}
+
+TEST_F(EepromStm32Test, TestFullLogCompactsInline) {
+    uint8_t expected[FEE_DENSITY_BYTES];
+    memset(expected, 0xFF, sizeof(expected));
+    // without EEPROM_Task() every compaction happens on a write
+    for (uint32_t i = 0; i < 3 * FEE_LOG_RECORDS; i++) {
+        uint16_t address = (i * 5) % FEE_DENSITY_BYTES;
+        uint8_t  value   = i;
+        EEPROM_WriteDataByte(address, value);
+        expected[address] = value;
+    }
+    EXPECT_EQ(flash_mock_program_errors, 0u);
+    EEPROM_Init();
+    for (uint16_t i = 0; i < FEE_DENSITY_BYTES; i++) {
+        EXPECT_EQ(EEPROM_ReadDataByte(i), expected[i]);
+    }
+}
+
+TEST_F(EepromStm32Test, TestEraseCountIsAmortized) {
+    const uint32_t writes = 10000;
+    for (uint32_t i = 0; i < writes; i++) {
+        EEPROM_WriteDataByte(i % 64, i);
+        EEPROM_Task();
+    }
+    // the previous layout erased a page and rewrote it for every changed byte
+    uint32_t erases_per_compaction = FEE_BANK_PAGES;
+    uint32_t max_compactions       = writes / FEE_COMPACT_THRESHOLD + 1;
+    EXPECT_LE(flash_mock_erase_count, erases_per_compaction * max_compactions);
+    // the smaller log of 1KB page parts compacts more often
+    EXPECT_LT(flash_mock_erase_count * 50, writes);
+}
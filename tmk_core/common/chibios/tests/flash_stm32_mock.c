@@ -0,0 +1,95 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "flash_stm32_mock.h"
+
+uint8_t  flash_mock[FLASH_MOCK_SIZE];
+uint32_t flash_mock_erase_count    = 0;
+uint32_t flash_mock_program_count  = 0;
+uint32_t flash_mock_program_errors = 0;
+int32_t  flash_mock_power_loss     = -1;
+
+// Counts down the erases and programs left before power is lost, if armed
+static bool flash_mock_powered(void) {
+    if (flash_mock_power_loss == 0) {
+        return false;
+    }
+    if (flash_mock_power_loss > 0) {
+        flash_mock_power_loss--;
+    }
+    return true;
+}
+
+void flash_mock_reset(void) {
+    memset(flash_mock, 0xFF, sizeof(flash_mock));
+    flash_mock_erase_count    = 0;
+    flash_mock_program_count  = 0;
+    flash_mock_program_errors = 0;
+    flash_mock_power_loss     = -1;
+}
+
+static int32_t flash_mock_offset(uint32_t Address) {
+    if (Address < FEE_PAGE_BASE_ADDRESS || Address >= FEE_LAST_PAGE_ADDRESS) {
+        return -1;
+    }
+    return Address - FEE_PAGE_BASE_ADDRESS;
+}
+
+FLASH_Status FLASH_ErasePage(uint32_t Page_Address) {
+    int32_t offset = flash_mock_offset(Page_Address);
+    if (offset < 0 || (offset % FEE_PAGE_SIZE) != 0) {
+        return FLASH_BAD_ADDRESS;
+    }
+    if (!flash_mock_powered()) {
+        return FLASH_TIMEOUT;
+    }
+    memset(&flash_mock[offset], 0xFF, FEE_PAGE_SIZE);
+    flash_mock_erase_count++;
+    return FLASH_COMPLETE;
+}
+
+FLASH_Status FLASH_ProgramHalfWord(uint32_t Address, uint16_t Data) {
+    int32_t offset = flash_mock_offset(Address);
+    if (offset < 0 || (offset & 1) != 0) {
+        return FLASH_BAD_ADDRESS;
+    }
+    if (!flash_mock_powered()) {
+        return FLASH_TIMEOUT;
+    }
+    // like the real flash, a half word can only be programmed once per erase
+    if (FLASH_ReadHalfWord(Address) != FEE_EMPTY_WORD) {
+        flash_mock_program_errors++;
+        return FLASH_ERROR_PG;
+    }
+    flash_mock[offset]     = Data & 0xFF;
+    flash_mock[offset + 1] = Data >> 8;
+    flash_mock_program_count++;
+    return FLASH_COMPLETE;
+}
+
+uint16_t FLASH_ReadHalfWord(uint32_t Address) {
+    int32_t offset = flash_mock_offset(Address);
+    if (offset < 0) {
+        return FEE_EMPTY_WORD;
+    }
+    return flash_mock[offset] | (flash_mock[offset + 1] << 8);
+}
+
+void FLASH_Unlock(void) {}
+void FLASH_Lock(void) {}
+void FLASH_ClearFlag(uint32_t FLASH_FLAG) {}
@@ -0,0 +1,30 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "eeprom_stm32.h"
+
+#define FLASH_MOCK_SIZE (FEE_DENSITY_PAGES * FEE_PAGE_SIZE)
+
+extern uint8_t  flash_mock[FLASH_MOCK_SIZE];
+extern uint32_t flash_mock_erase_count;
+extern uint32_t flash_mock_program_count;
+extern uint32_t flash_mock_program_errors;
+extern int32_t  flash_mock_power_loss;  // flash operations until power is lost, -1 for never
+
+void flash_mock_reset(void);
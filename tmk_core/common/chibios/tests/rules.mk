@@ -0,0 +1,13 @@
+eeprom_stm32_DEFS := -DEEPROM_TEST_HARNESS -DEEPROM_EMU_STM32F303xC
+
+eeprom_stm32_INC := \
+	$(TMK_PATH)/common/chibios
+
+eeprom_stm32_SRC := \
+	$(TMK_PATH)/common/chibios/tests/flash_stm32_mock.c \
+	$(TMK_PATH)/common/chibios/tests/eeprom_stm32_tests.cpp \
+	$(TMK_PATH)/common/chibios/eeprom_stm32.c
+
+eeprom_stm32_1k_DEFS := -DEEPROM_TEST_HARNESS -DEEPROM_EMU_STM32F103xB
+eeprom_stm32_1k_INC := $(eeprom_stm32_INC)
+eeprom_stm32_1k_SRC := $(eeprom_stm32_SRC)
@@ -0,0 +1,2 @@
+TEST_LIST += eeprom_stm32
+TEST_LIST += eeprom_stm32_1k
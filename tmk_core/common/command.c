@@ -206,6 +206,9 @@ static void print_status(void) {
     print_val_hex8(keymap_config.nkro);
 #endif
     print_val_hex32(timer_read32());
+#if defined(TAPPING_STATS) && !defined(NO_ACTION_TAPPING)
+    tapping_stats_print();
+#endif
     return;
 }
 
@@ -1,8 +1,10 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "timer.h"
 
 #ifdef STM32_EEPROM_ENABLE
 #    include <hal.h>
@@ -17,6 +19,39 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EECONFIG_DEFERRED_WRITE
+static uint8_t  eeconfig_pending[EECONFIG_SIZE];
+static uint8_t  eeconfig_dirty[(EECONFIG_SIZE + 7) / 8];
+static bool     eeconfig_has_pending = false;
+static uint32_t eeconfig_last_update = 0;
+
+static inline bool eeconfig_is_dirty(uint8_t offset) { return eeconfig_dirty[offset / 8] & (1 << (offset % 8)); }
+
+static void eeconfig_discard(void) {
+    memset(eeconfig_dirty, 0, sizeof(eeconfig_dirty));
+    eeconfig_has_pending = false;
+}
+
+/* Write out the first run of dirty bytes, returns false once nothing is left. */
+static bool eeconfig_flush_next(void) {
+    uint8_t start = 0;
+    while (start < EECONFIG_SIZE && !eeconfig_is_dirty(start)) {
+        start++;
+    }
+    if (start == EECONFIG_SIZE) {
+        eeconfig_has_pending = false;
+        return false;
+    }
+    uint8_t end = start;
+    while (end < EECONFIG_SIZE && eeconfig_is_dirty(end)) {
+        eeconfig_dirty[end / 8] &= ~(1 << (end % 8));
+        end++;
+    }
+    eeconfig_flush_chunk(&eeconfig_pending[start], (void *)(uintptr_t)start, end - start);
+    return true;
+}
+#endif
+
 /** \brief eeconfig enable
  *
  * FIXME: needs doc
@@ -37,6 +72,9 @@ __attribute__((weak)) void eeconfig_init_kb(void) {
  * FIXME: needs doc
  */
 void eeconfig_init_quantum(void) {
+#ifdef EECONFIG_DEFERRED_WRITE
+    eeconfig_discard();
+#endif
 #ifdef STM32_EEPROM_ENABLE
     EEPROM_Erase();
 #endif
@@ -98,6 +136,9 @@ void eeconfig_enable(void) { eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_N
  * FIXME: needs doc
  */
 void eeconfig_disable(void) {
+#ifdef EECONFIG_DEFERRED_WRITE
+    eeconfig_discard();
+#endif
 #ifdef STM32_EEPROM_ENABLE
     EEPROM_Erase();
 #endif
@@ -220,3 +261,74 @@ bool eeconfig_read_handedness(void) { return !!eeprom_read_byte(EECONFIG_HANDEDN
  * FIXME: needs doc
  */
 void eeconfig_update_handedness(bool val) { eeprom_update_byte(EECONFIG_HANDEDNESS, !!val); }
+
+/** \brief eeconfig read deferred
+ *
+ * Reads a config region, including updates that have not been flushed yet.
+ */
+void eeconfig_read_deferred(void *buf, const void *addr, size_t len) {
+    eeprom_read_block(buf, addr, len);
+#ifdef EECONFIG_DEFERRED_WRITE
+    if (eeconfig_has_pending) {
+        uintptr_t offset = (uintptr_t)addr;
+        uint8_t * dest   = (uint8_t *)buf;
+        for (size_t i = 0; i < len && offset + i < EECONFIG_SIZE; i++) {
+            if (eeconfig_is_dirty(offset + i)) {
+                dest[i] = eeconfig_pending[offset + i];
+            }
+        }
+    }
+#endif
+}
+/** \brief eeconfig update deferred
+ *
+ * Queues an update of a config region. Repeated updates to the same bytes are
+ * merged and written once EECONFIG_DEFERRED_WRITE_TIMEOUT ms have passed
+ * without another update. Without EECONFIG_DEFERRED_WRITE this writes through.
+ */
+void eeconfig_update_deferred(const void *buf, void *addr, size_t len) {
+#ifdef EECONFIG_DEFERRED_WRITE
+    uintptr_t offset = (uintptr_t)addr;
+    if (offset + len <= EECONFIG_SIZE) {
+        const uint8_t *src = (const uint8_t *)buf;
+        for (size_t i = 0; i < len; i++, offset++) {
+            eeconfig_pending[offset] = src[i];
+            eeconfig_dirty[offset / 8] |= (1 << (offset % 8));
+        }
+        eeconfig_has_pending = true;
+        eeconfig_last_update = timer_read32();
+        return;
+    }
+#endif
+    eeprom_update_block(buf, addr, len);
+}
+
+/** \brief eeconfig flush chunk
+ *
+ * Writes one contiguous run of queued bytes. Override this to hand the whole
+ * run to an EEPROM driver that can write it in a single transaction.
+ */
+__attribute__((weak)) void eeconfig_flush_chunk(const void *buf, void *addr, size_t len) { eeprom_update_block(buf, addr, len); }
+
+/** \brief eeconfig flush
+ *
+ * Writes all queued updates now, used before suspend and bootloader jumps.
+ */
+void eeconfig_flush(void) {
+#ifdef EECONFIG_DEFERRED_WRITE
+    while (eeconfig_flush_next()) {
+    }
+#endif
+}
+
+/** \brief eeconfig task
+ *
+ * Writes one run of queued updates per call once the quiet period has passed.
+ */
+void eeconfig_task(void) {
+#ifdef EECONFIG_DEFERRED_WRITE
+    if (eeconfig_has_pending && timer_elapsed32(eeconfig_last_update) >= EECONFIG_DEFERRED_WRITE_TIMEOUT) {
+        eeconfig_flush_next();
+    }
+#endif
+}
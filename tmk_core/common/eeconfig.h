@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef EECONFIG_MAGIC_NUMBER
 #    define EECONFIG_MAGIC_NUMBER (uint16_t)0xFEEC
@@ -67,6 +68,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define EECONFIG_KEYMAP_LOWER_BYTE EECONFIG_KEYMAP
 
+// Quiet period in ms before deferred config writes are flushed to EEPROM
+#if defined(EECONFIG_DEFERRED_WRITE) && !defined(EECONFIG_DEFERRED_WRITE_TIMEOUT)
+#    define EECONFIG_DEFERRED_WRITE_TIMEOUT 1000
+#endif
+
 bool eeconfig_is_enabled(void);
 bool eeconfig_is_disabled(void);
 
@@ -110,3 +116,9 @@ void     eeconfig_update_haptic(uint32_t val);
 
 bool eeconfig_read_handedness(void);
 void eeconfig_update_handedness(bool val);
+
+void eeconfig_read_deferred(void *buf, const void *addr, size_t len);
+void eeconfig_update_deferred(const void *buf, void *addr, size_t len);
+void eeconfig_flush_chunk(const void *buf, void *addr, size_t len);
+void eeconfig_flush(void);
+void eeconfig_task(void);
@@ -30,6 +30,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "profiler.h"
+#ifdef KEYBOARD_REPORT_COALESCE
+#    include "action_util.h"
+#endif
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -92,9 +96,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
+#ifdef I2C_QUEUE_ENABLE
+#    include "i2c_queue.h"
+#endif
 
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE)
@@ -256,6 +266,30 @@ __attribute__((weak)) void housekeeping_task_kb(void) {}
  */
 __attribute__((weak)) void housekeeping_task_user(void) {}
 
+/** \brief matrix_event_time
+ *
+ * Override this function if the matrix learns about some changes after they happened:
+ *   - splits that report when the other half saw a key change
+ */
+__attribute__((weak)) uint16_t matrix_event_time(uint8_t row, uint8_t col) { return timer_read(); }
+
+/** \brief key_event_time
+ *
+ * The time given to action_exec for a matrix change. Events must stay in order, so
+ * one reported late is never older than the event processed before it.
+ */
+static uint16_t key_event_time(uint8_t row, uint8_t col) {
+    static uint16_t last_time;
+    uint16_t        now  = timer_read();
+    uint16_t        time = matrix_event_time(row, col);
+
+    if (TIMER_DIFF_16(now, time) > TIMER_DIFF_16(now, last_time)) {
+        time = last_time;
+    }
+    last_time = time;
+    return time | 1; /* time should not be 0 */
+}
+
 /** \brief keyboard_init
  *
  * FIXME: needs doc
@@ -266,6 +300,9 @@ void keyboard_init(void) {
 #ifdef VIA_ENABLE
     via_init();
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_init();
+#endif
 #ifdef QWIIC_ENABLE
     qwiic_init();
 #endif
@@ -333,23 +370,33 @@ void keyboard_init(void) {
  */
 void keyboard_task(void) {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
-    uint8_t keys_processed = 0;
+    static uint8_t      led_status     = 0;
+    matrix_row_t        matrix_row     = 0;
+    matrix_row_t        matrix_change  = 0;
+    uint8_t             keys_processed = 0;
+
+#ifdef PROFILER_ENABLE
+    profile_task();
 #endif
 
     housekeeping_task_kb();
     housekeeping_task_user();
 
+    PROFILE_START(scan);
 #if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
     uint8_t ret = matrix_scan();
 #else
     matrix_scan();
 #endif
+    PROFILE_END(scan, PROFILE_MATRIX_SCAN);
 
+    PROFILE_START(action);
     if (should_process_keypress()) {
+#ifdef KEYBOARD_REPORT_COALESCE
+        keyboard_report_batch_begin();
+#endif
+        // Every change found by this scan is handed to action_exec in matrix order,
+        // so a chord reaches the host within a single task call.
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row    = matrix_get_row(r);
             matrix_change = matrix_row ^ matrix_prev[r];
@@ -364,36 +411,45 @@ void keyboard_task(void) {
                 for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
                     if (matrix_change & col_mask) {
                         action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
+                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = key_event_time(r, c)
                         });
                         // record a processed key
                         matrix_prev[r] ^= col_mask;
+                        keys_processed++;
 #ifdef QMK_KEYS_PER_SCAN
                         // only jump out if we have processed "enough" keys.
-                        if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
-                            // process a key per task call
+                        if (keys_processed >= QMK_KEYS_PER_SCAN) {
+                            // leave the rest for the next task call
                             goto MATRIX_LOOP_END;
+                        }
+#endif
                     }
                 }
             }
         }
     }
     // call with pseudo tick event when no real key event.
-#ifdef QMK_KEYS_PER_SCAN
-    // we can get here with some keys processed now.
-    if (!keys_processed)
-#endif
+    if (!keys_processed) {
         action_exec(TICK);
+    }
 
+#ifdef QMK_KEYS_PER_SCAN
 MATRIX_LOOP_END:
+#endif
+
+#ifdef KEYBOARD_REPORT_COALESCE
+    keyboard_report_batch_end();
+#endif
+    PROFILE_END(action, PROFILE_ACTION_EXEC);
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
 #if defined(RGBLIGHT_ENABLE)
+    PROFILE_START(rgblight);
     rgblight_task();
+    PROFILE_END(rgblight, PROFILE_RGBLIGHT);
 #endif
 
 #if defined(BACKLIGHT_ENABLE)
@@ -403,7 +459,9 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef ENCODER_ENABLE
+    PROFILE_START(encoder);
     encoder_read();
+    PROFILE_END(encoder, PROFILE_ENCODER);
 #endif
 
 #ifdef QWIIC_ENABLE
@@ -411,7 +469,9 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef OLED_DRIVER_ENABLE
+    PROFILE_START(oled);
     oled_task();
+    PROFILE_END(oled, PROFILE_OLED);
 #    ifndef OLED_DISABLE_TIMEOUT
     // Wake up oled if user is using those fabulous keys!
     if (ret) oled_on();
@@ -457,6 +517,14 @@ MATRIX_LOOP_END:
     }
 #endif
 
+#ifdef EECONFIG_DEFERRED_WRITE
+    eeconfig_task();
+#endif
+
+#ifdef I2C_QUEUE_ENABLE
+    i2c_queue_task();
+#endif
+
 #ifdef JOYSTICK_ENABLE
     joystick_task();
 #endif
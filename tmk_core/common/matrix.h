@@ -56,6 +56,23 @@ matrix_row_t matrix_get_row(uint8_t row);
 void matrix_print(void);
 /* delay between changing matrix pin state and reading values */
 void matrix_io_delay(void);
+/* when the change of a switch found by the last scan happened, timer_read() unless overridden */
+uint16_t matrix_event_time(uint8_t row, uint8_t col);
+
+#ifdef MATRIX_SCAN_INTERRUPT
+/* interrupt driven scanning, see MATRIX_SCAN_MODE */
+bool matrix_wakeup_poll(void);
+void matrix_wakeup_update(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+void matrix_wakeup_signal(void);
+/* platform/keyboard hooks: enable change interrupts on the sense lines, false if unsupported */
+bool matrix_wakeup_arm(void);
+void matrix_wakeup_disarm(void);
+void matrix_wakeup_wait(void);
+/* implemented by the matrix: drive every strobe line, release them, read the sense lines */
+void matrix_idle_enter(void);
+void matrix_idle_exit(void);
+bool matrix_idle_probe(void);
+#endif
 
 /* power control */
 void matrix_power_up(void);
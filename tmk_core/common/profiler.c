@@ -0,0 +1,118 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+#include <stdbool.h>
+#include <string.h>
+#include "debug.h"
+#include "print.h"
+
+#if PROFILER_SAMPLES > 255
+#    error "PROFILER_SAMPLES must be 255 or less"
+#endif
+
+typedef struct {
+    uint16_t samples[PROFILER_SAMPLES];
+    uint8_t  next;
+    uint8_t  count;
+} profile_ring_t;
+
+static profile_ring_t profile_rings[PROFILE_STAGE_COUNT];
+static uint32_t       profile_report_timer;
+static uint32_t       profile_loop_start;
+static bool           profile_loop_started;
+
+#ifndef NO_PRINT
+static const char *const profile_stage_names[PROFILE_STAGE_COUNT] = {
+    [PROFILE_LOOP] = "loop", [PROFILE_MATRIX_SCAN] = "matrix_scan", [PROFILE_ACTION_EXEC] = "action_exec", [PROFILE_RGBLIGHT] = "rgblight", [PROFILE_RGB_MATRIX] = "rgb_matrix", [PROFILE_OLED] = "oled", [PROFILE_ENCODER] = "encoder", [PROFILE_HOST_SEND] = "host_send",
+};
+#endif
+
+void profile_record(profile_stage_t stage, uint32_t duration_us) {
+    if (stage >= PROFILE_STAGE_COUNT) {
+        return;
+    }
+
+    profile_ring_t *ring      = &profile_rings[stage];
+    ring->samples[ring->next] = duration_us > UINT16_MAX ? UINT16_MAX : duration_us;
+    ring->next                = (ring->next + 1) % PROFILER_SAMPLES;
+    if (ring->count < PROFILER_SAMPLES) {
+        ring->count++;
+    }
+}
+
+profile_stats_t profile_get_stats(profile_stage_t stage) {
+    profile_stats_t stats = {0};
+    if (stage >= PROFILE_STAGE_COUNT || profile_rings[stage].count == 0) {
+        return stats;
+    }
+
+    // Sort a copy of the window, min/max/p99 then fall out of the ordering
+    const profile_ring_t *ring = &profile_rings[stage];
+    uint16_t              sorted[PROFILER_SAMPLES];
+    uint32_t              sum = 0;
+    for (uint8_t i = 0; i < ring->count; i++) {
+        uint16_t value = ring->samples[i];
+        uint8_t  j     = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+        sum += value;
+    }
+
+    stats.samples = ring->count;
+    stats.min     = sorted[0];
+    stats.max     = sorted[ring->count - 1];
+    stats.avg     = sum / ring->count;
+    stats.p99     = sorted[((uint16_t)ring->count * 99 + 99) / 100 - 1];
+    return stats;
+}
+
+void profile_reset(void) {
+    memset(profile_rings, 0, sizeof(profile_rings));
+    profile_report_timer = timer_read32();
+    profile_loop_started = false;
+}
+
+void profile_print(void) {
+#ifndef NO_PRINT
+    for (uint8_t stage = 0; stage < PROFILE_STAGE_COUNT; stage++) {
+        profile_stats_t stats = profile_get_stats(stage);
+        if (stats.samples) {
+            xprintf("%-12s min %5u avg %5u max %5u p99 %5u us (n=%u)\n", profile_stage_names[stage], stats.min, stats.avg, stats.max, stats.p99, stats.samples);
+        }
+    }
+#endif
+}
+
+void profile_task(void) {
+    // The loop stage is the time between consecutive calls, so it includes the USB tasks as well
+    uint32_t now = timer_read_us();
+    if (profile_loop_started) {
+        profile_record(PROFILE_LOOP, TIMER_DIFF_32(now, profile_loop_start));
+    }
+    profile_loop_start   = now;
+    profile_loop_started = true;
+
+    if (timer_elapsed32(profile_report_timer) >= PROFILER_REPORT_INTERVAL) {
+        profile_report_timer = timer_read32();
+        if (debug_enable) {
+            profile_print();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "timer.h"
+
+/* Main loop profiler.
+ *
+ * Each stage keeps its most recent PROFILER_SAMPLES durations in a ring, and
+ * statistics are computed over that window when they are read. Stages nest:
+ * rgb_matrix runs inside matrix_scan and host sends inside action_exec, and
+ * their time is included in the enclosing stage as well.
+ */
+
+#ifndef PROFILER_SAMPLES
+#    define PROFILER_SAMPLES 64
+#endif
+
+#ifndef PROFILER_REPORT_INTERVAL
+#    define PROFILER_REPORT_INTERVAL 5000
+#endif
+
+typedef enum {
+    PROFILE_LOOP,
+    PROFILE_MATRIX_SCAN,
+    PROFILE_ACTION_EXEC,
+    PROFILE_RGBLIGHT,
+    PROFILE_RGB_MATRIX,
+    PROFILE_OLED,
+    PROFILE_ENCODER,
+    PROFILE_HOST_SEND,
+    PROFILE_STAGE_COUNT,
+} profile_stage_t;
+
+typedef struct {
+    uint16_t samples;  // number of samples in the window
+    uint16_t min;
+    uint16_t avg;
+    uint16_t max;
+    uint16_t p99;
+} profile_stats_t;
+
+#ifdef PROFILER_ENABLE
+#    define PROFILE_START(name) uint32_t profile_start_##name = timer_read_us()
+#    define PROFILE_END(name, stage) profile_record(stage, timer_elapsed_us(profile_start_##name))
+#else
+#    define PROFILE_START(name)
+#    define PROFILE_END(name, stage)
+#endif
+
+void            profile_record(profile_stage_t stage, uint32_t duration_us);
+profile_stats_t profile_get_stats(profile_stage_t stage);
+void            profile_reset(void);
+void            profile_print(void);
+void            profile_task(void);  // once per keyboard_task, records PROFILE_LOOP and prints reports
@@ -0,0 +1,82 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "profiler.h"
+void advance_time(uint32_t ms);
+}
+
+class ProfilerTest : public ::testing::Test {
+   protected:
+    void SetUp() override { profile_reset(); }
+};
+
+TEST_F(ProfilerTest, TestEmptyStage) {
+    profile_stats_t stats = profile_get_stats(PROFILE_OLED);
+    EXPECT_EQ(stats.samples, 0);
+    EXPECT_EQ(stats.max, 0);
+}
+
+TEST_F(ProfilerTest, TestStatsOverWindow) {
+    // 1..100us in a scrambled order
+    for (uint32_t i = 0; i < 100; i++) {
+        profile_record(PROFILE_MATRIX_SCAN, (i * 37) % 100 + 1);
+    }
+    profile_stats_t stats = profile_get_stats(PROFILE_MATRIX_SCAN);
+    EXPECT_EQ(stats.samples, 100);
+    EXPECT_EQ(stats.min, 1);
+    EXPECT_EQ(stats.max, 100);
+    EXPECT_EQ(stats.avg, 50);
+    EXPECT_EQ(stats.p99, 99);
+}
+
+TEST_F(ProfilerTest, TestRingDropsOldestSamples) {
+    for (uint32_t i = 0; i < 100; i++) {
+        profile_record(PROFILE_ACTION_EXEC, 5000);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        profile_record(PROFILE_ACTION_EXEC, 10);
+    }
+    profile_stats_t stats = profile_get_stats(PROFILE_ACTION_EXEC);
+    EXPECT_EQ(stats.samples, 100);
+    EXPECT_EQ(stats.max, 10);
+}
+
+TEST_F(ProfilerTest, TestLongSamplesSaturate) {
+    profile_record(PROFILE_RGB_MATRIX, 100000);
+    EXPECT_EQ(profile_get_stats(PROFILE_RGB_MATRIX).max, UINT16_MAX);
+}
+
+TEST_F(ProfilerTest, TestLoopPeriod) {
+    profile_task();
+    advance_time(2);
+    profile_task();
+    advance_time(1);
+    profile_task();
+    profile_stats_t stats = profile_get_stats(PROFILE_LOOP);
+    EXPECT_EQ(stats.samples, 2);
+    EXPECT_EQ(stats.min, 1000);
+    EXPECT_EQ(stats.max, 2000);
+}
+
+TEST_F(ProfilerTest, TestMacrosRecordStage) {
+    PROFILE_START(encoder);
+    advance_time(3);
+    PROFILE_END(encoder, PROFILE_ENCODER);
+    EXPECT_EQ(profile_get_stats(PROFILE_ENCODER).avg, 3000);
+}
@@ -0,0 +1,7 @@
+profiler_DEFS := -DPROFILER_ENABLE -DNO_PRINT -DPROFILER_SAMPLES=100
+
+profiler_SRC := \
+	$(TMK_PATH)/common/tests/profiler_tests.cpp \
+	$(TMK_PATH)/common/profiler.c \
+	$(TMK_PATH)/common/debug.c \
+	$(TMK_PATH)/common/test/timer.c
@@ -265,6 +265,9 @@ int main(void) {
 #ifdef RAW_ENABLE
         raw_hid_task();
 #endif
+#ifdef STM32_EEPROM_ENABLE
+        EEPROM_Task();
+#endif
 
         // Run housekeeping
         housekeeping_task_kb();